@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts heap allocations made through global operator new, per thread.
+// Opt in by defining BOARDGAME_COUNT_ALLOCATIONS, which replaces operator new/delete in AllocationCounter.cpp.
+// Without it the counters stay at zero and isEnabled() is false.
+namespace AllocationCounter {
+
+struct Snapshot {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+bool isEnabled();
+
+// Totals for the calling thread since it started
+Snapshot current();
+
+// Allocations made on this thread between construction and since()
+class Scope
+{
+public:
+    Scope() : m_start(current()) {}
+
+    Snapshot since() const
+    {
+        Snapshot now = current();
+        return { now.allocations - m_start.allocations, now.bytes - m_start.bytes };
+    }
+
+private:
+    Snapshot m_start;
+};
+
+} // namespace AllocationCounter
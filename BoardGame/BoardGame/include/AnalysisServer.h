@@ -0,0 +1,119 @@
+#pragma once
+
+#include "GameState.h"
+#include "MiniMax.h"
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+struct AnalysisServerOptions {
+    unsigned short port = 5055; // bound to loopback only
+    int threads = 0;            // 0 = one worker per core
+    int defaultDepth = 4;       // used when a request gives no depth, time or node limit, or is deterministic
+                                // without a depth or node limit
+};
+
+// Totals since the server started, times in milliseconds
+struct AnalysisMetrics {
+    uint64_t received = 0;
+    uint64_t completed = 0;
+    uint64_t rejected = 0;      // malformed requests, answered with an error line
+    int queueDepth = 0;
+    int peakQueueDepth = 0;
+    int busyWorkers = 0;
+    uint64_t nodes = 0;
+    double totalWaitMs = 0.0;   // arrival until a worker picks it up
+    double maxWaitMs = 0.0;
+    double totalLatencyMs = 0.0; // arrival until the result is ready
+    double maxLatencyMs = 0.0;
+};
+
+// Position analysis as a local service. Clients connect over TCP on 127.0.0.1 and send lines:
+//
+//   analyze <id> <board> [turn player|ai] [depth N] [movetime ms] [nodes N] [deterministic]
+//       board as in Notation.h, movement phase positions only. Any number of these can be sent in one
+//       batch, they are queued and spread over the worker pool. deterministic gives the same result
+//       whichever worker and whatever it searched before (SearchLimits::deterministic). It ignores
+//       movetime, so without depth or nodes it searches the default depth.
+//       -> result <id> bestmove <move|none> score S depth D nodes N wait ms time ms pv <moves...>
+//       -> error <id> <reason>
+//   metrics     -> metrics queued .. peak .. busy .. received .. completed .. wait_avg .. latency_avg ..
+//   quit        closes this connection
+//   shutdown    stops the server
+//
+// Each connection gets its results in the order it sent the requests. Every worker owns its own engines,
+// so each has a private transposition table that stays warm between requests.
+class AnalysisServer
+{
+public:
+    AnalysisServer(const AnalysisServerOptions& options);
+    ~AnalysisServer();
+
+    // Serves until a client sends shutdown, false if the port could not be opened
+    bool run();
+
+    AnalysisMetrics getMetrics() const;
+
+private:
+    struct Request {
+        uint64_t sequence;
+        std::string id;
+        GameState state;
+        PieceOwner side;
+        SearchLimits limits;
+        std::chrono::steady_clock::time_point arrival;
+    };
+
+    struct Client {
+        sf::TcpSocket socket;
+        std::string buffer;               // bytes after the last complete line
+        std::deque<uint64_t> pending;     // sequences of this client's requests, oldest first
+        bool closed = false;
+    };
+
+    struct Worker {
+        std::unique_ptr<MiniMax> playerEngine;
+        std::unique_ptr<MiniMax> aiEngine;
+        std::thread thread;
+    };
+
+    bool handleLine(Client& client, const std::string& line); // false on shutdown
+    void queueRequest(Client& client, std::istringstream& tokens);
+    void finish(uint64_t sequence, const std::string& line);
+    void reject(uint64_t sequence, const std::string& line);
+    void sendFinished(Client& client);
+    void dropPending(const Client& client);
+    void workerLoop(Worker& worker);
+    std::string analyze(Worker& worker, const Request& request, double waitMs);
+    std::string formatMetrics() const;
+
+    AnalysisServerOptions m_options;
+    std::vector<std::unique_ptr<Piece>> m_pieces; // read only pool every queued position points into
+    std::vector<Piece*> m_piecePool;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::unique_ptr<Client>> m_clients;
+    uint64_t m_nextSequence;
+
+    std::deque<Request> m_queue;
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueReady;
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_stopSearches; // ends searches in flight on shutdown
+
+    std::unordered_map<uint64_t, std::string> m_finished; // result lines waiting for their turn to be sent
+    std::unordered_set<uint64_t> m_abandoned; // searches in flight for closed connections, finish drops them
+    std::mutex m_finishedMutex;
+
+    AnalysisMetrics m_metrics;
+    mutable std::mutex m_metricsMutex;
+};
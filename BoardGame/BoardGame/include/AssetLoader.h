@@ -0,0 +1,43 @@
+#ifndef ASSET_LOADER_HPP
+#define ASSET_LOADER_HPP
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Decodes assets on background threads while the window is already up.
+//Jobs only do file IO and decoding, anything that touches the GPU (texture upload) stays on the main thread
+//and is done once isFinished() is true.
+class AssetLoader
+{
+public:
+    AssetLoader();
+    ~AssetLoader(); // waits for the workers
+
+    // Job returns false when the asset failed to load. Add every job before start()
+    void addJob(const std::string& name, std::function<bool()> job);
+    void start(int threads = 0); // 0 = one per core, capped at the job count
+    void wait();
+
+    bool isFinished() const { return m_completed.load() == (int)m_jobs.size(); }
+    int getCompleted() const { return m_completed.load(); }
+    int getTotal() const { return (int)m_jobs.size(); }
+    float getProgress() const { return m_jobs.empty() ? 1.0f : (float)m_completed.load() / m_jobs.size(); }
+
+private:
+    struct Job {
+        std::string name;
+        std::function<bool()> run;
+    };
+
+    void worker();
+
+    std::vector<Job> m_jobs;
+    std::vector<std::thread> m_threads;
+    std::atomic<int> m_nextJob;
+    std::atomic<int> m_completed;
+};
+
+#endif
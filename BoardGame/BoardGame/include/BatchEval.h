@@ -0,0 +1,64 @@
+#pragma once
+
+#include "GameState.h"
+#include "EvalParams.h"
+#include "SelfPlay.h"
+#include <cstddef>
+#include <cstdint>
+
+// GameState::evaluate only looks at who owns each square, so a position packs into two bitboards
+// (bit col * 5 + row) and a batch of them sits in one contiguous array
+struct PackedPosition {
+    uint32_t player = 0;
+    uint32_t ai = 0;
+
+    static PackedPosition fromState(const GameState& state);
+    static PackedPosition fromSample(const PositionSample& sample);
+};
+
+enum class BatchKernel {
+    SCALAR,
+    SSE2, // 4 positions per step
+    AVX2  // 8 positions per step, only when the CPU and OS support it
+};
+
+// Evaluates many positions at once with the same result GameState::evaluate gives each of them.
+// The weights are folded into per line and per square tables when the evaluator is built, so the kernels
+// only mask, compare and add. Build a new evaluator when the weights change.
+class BatchEvaluator
+{
+public:
+    explicit BatchEvaluator(const EvalParams& params = EvalParams::active());
+
+    // scores[i] = evaluate(player) of positions[i], on the fastest kernel this machine has
+    void evaluate(const PackedPosition* positions, size_t count, PieceOwner player, int* scores) const;
+    void evaluate(const PackedPosition* positions, size_t count, PieceOwner player, int* scores,
+        BatchKernel kernel) const;
+
+    static BatchKernel getBestKernel();
+    static bool isSupported(BatchKernel kernel);
+    static const char* getKernelName(BatchKernel kernel);
+
+private:
+    // Everything a kernel needs for one point of view. Kernels always read the player bits against the
+    // player tables and the AI bits against the AI tables, the point of view only changes the numbers in them.
+    struct Tables {
+        int32_t playerLine[8];   // by piece count on a line the other side has no piece on, padded for the AVX2 permute
+        int32_t aiLine[8];
+        int32_t playerSquare[25]; // centre value of each square, already weighted and signed
+        int32_t aiSquare[25];
+        int32_t playerWin;        // score when the player has four, checked first as getWinner does
+        int32_t aiWin;
+    };
+
+    const Tables& getTables(PieceOwner player) const;
+
+    void evaluateScalar(const PackedPosition* positions, size_t count, const Tables& tables, int* scores) const;
+    void evaluateSse2(const PackedPosition* positions, size_t count, const Tables& tables, int* scores) const;
+    void evaluateAvx2(const PackedPosition* positions, size_t count, const Tables& tables, int* scores) const;
+
+    Tables m_playerTables;
+    Tables m_aiTables;
+    uint32_t m_lineMasks[GameState::LINE_COUNT];
+    uint8_t m_lineCells[GameState::LINE_COUNT][4];
+};
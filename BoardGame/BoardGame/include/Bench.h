@@ -0,0 +1,94 @@
+#pragma once
+
+#include "GameState.h"
+#include "MiniMax.h"
+#include "SearchStats.h"
+#include "BatchEval.h"
+#include "PositionIndex.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct BenchOptions {
+    int depth = 4;        // 0 searches to the node budget alone
+    uint64_t nodes = 0;   // node budget per search, searched with SearchLimits::deterministic when set
+    int positions = 32;   // movement phase positions reached by random placements
+    uint64_t seed = 1;
+    int lines = 1;        // multi-PV lines per search
+    SearchFeatures features;
+    std::string jsonPath; // per position search stats, written when set
+    std::string csvPath;
+};
+
+// Fixed search benchmark: the same positions searched to the same depth every run,
+// so node counts and speed can be compared between builds. The signature hashes every search's move, score
+// and node count; with a node budget it is the same on every machine, so one number says whether a change
+// altered the search.
+class Bench
+{
+public:
+    Bench(const BenchOptions& options);
+
+    SearchStats run();
+
+private:
+    void generatePositions();
+    bool writeJson(const std::vector<SearchStats>& results) const;
+    bool writeCsv(const std::vector<SearchStats>& results) const;
+
+    BenchOptions m_options;
+    std::vector<std::unique_ptr<Piece>> m_pieces; // headless pool shared by every position
+    std::vector<GameState> m_positions;
+};
+
+struct EvalBenchOptions {
+    int positions = 65536; // reached by random placements and random moves, finished games included
+    int rounds = 20;       // passes over the whole batch per kernel
+    uint64_t seed = 1;
+};
+
+// Evaluation throughput: GameState::evaluate one position at a time against every BatchEvaluator kernel
+// the machine supports, checking each kernel gives exactly the same scores from both sides.
+class EvalBench
+{
+public:
+    EvalBench(const EvalBenchOptions& options);
+
+    // False when any kernel disagrees with GameState::evaluate
+    bool run();
+
+private:
+    void generatePositions();
+
+    EvalBenchOptions m_options;
+    std::vector<std::unique_ptr<Piece>> m_pieces;
+    std::vector<GameState> m_states;
+    std::vector<PackedPosition> m_positions;
+};
+
+struct RankBenchOptions {
+    int positions = 65536;   // full material movement positions from random placements and random moves
+    int rounds = 20;
+    int indexSamples = 1 << 20; // random indices unranked to measure how dense the index range is
+    uint64_t seed = 1;
+};
+
+// PositionIndex throughput against the symmetry reduced Zobrist hash it can replace as a table key, and its
+// checks: unrank gives back a symmetric image of the position, all 8 images rank the same
+class RankBench
+{
+public:
+    RankBench(const RankBenchOptions& options);
+
+    // False when any check fails
+    bool run();
+
+private:
+    void generatePositions();
+
+    RankBenchOptions m_options;
+    std::vector<std::unique_ptr<Piece>> m_pieces;
+    std::vector<GameState> m_states;
+    std::vector<MaterialSquares> m_squares;
+};
@@ -1,8 +1,8 @@
 #ifndef BOARD_HPP
 #define BOARD_HPP
 
+#include "BoardGeometry.h"
 #include <SFML/Graphics.hpp>
-#include <unordered_map>
 #include <string>
 
 //Mental reminder Board.h/.cpp is for drawing board game cells and managing positions/grid logic
@@ -21,18 +21,6 @@ struct GridPos
 };
 
 
-namespace std //covert GridPosition to unique num
-{
-    template <>
-    struct hash<GridPos>
-    {
-        size_t operator()(const GridPos& pos) const //unique num
-        {
-            return hash<int>()(pos.x) ^ (hash<int>()(pos.y) << 1);
-        }
-    };
-}
-
 class Board
 {
 public:
@@ -44,8 +32,17 @@ public:
     void initializePieceSelectionGrid();
     void initializeGameBoard();
 
-    sf::RectangleShape* getPieceSelectionCell(int col, int row);
-    sf::RectangleShape* getGameBoardCell(int col, int row);
+    // Top left corner of a cell in pixels
+    sf::Vector2f getPieceSelectionCellPosition(int col, int row) const;
+    sf::Vector2f getGameBoardCellPosition(int col, int row) const;
+
+    // Recolours one cell by patching its 6 vertices, out of range cells are ignored
+    void setPieceSelectionCellColor(int col, int row, sf::Color color);
+    void setGameBoardCellColor(int col, int row, sf::Color color);
+    void resetCellColors(); // back to the default fills, only touching cells that were changed
+
+    static const sf::Color SELECTION_CELL_COLOR;
+    static const sf::Color BOARD_CELL_COLOR;
 
     //mouse
     GridPos screenToSelectionGrid(int mouseX, int mouseY); //convert pixel coord to selection grid pos
@@ -54,15 +51,29 @@ public:
     bool isInGameBoard(int mouseX, int mouseY); //ensures the click its inside of the boaord grid
 
 private:
+    void addCell(int cellIndex, sf::Vector2f position, sf::Color color);
+    void setCellColor(int cellIndex, sf::Color color);
 
     //grid setup
     const float CELL_SIZE = 100.0f;
     const float GRID_OFFSET_X = 50.0f;
     const float GRID_OFFSET_Y = 100.0f;
     const float BOARD_OFFSET_X = 400.0f;
+    const float OUTLINE_THICKNESS = 2.0f;
+
+    // Cells 0-9 are the selection grid (col * 5 + row), 10-34 the game board (10 + col * 5 + row)
+    using Geometry = StandardGeometry;
+    static constexpr int SELECTION_COLUMNS = 2;
+    static constexpr int SELECTION_ROWS = 5; // one row per piece each side places
+    static constexpr int SELECTION_CELLS = SELECTION_COLUMNS * SELECTION_ROWS;
+    static constexpr int CELL_COUNT = SELECTION_CELLS + Geometry::CELLS;
+    static constexpr int VERTS_PER_FILL = 6;     // two triangles
+    static constexpr int VERTS_PER_OUTLINE = 24; // four edge quads
 
-    std::unordered_map<GridPos, sf::RectangleShape> pieceSelectionGrid;
-    std::unordered_map<GridPos, sf::RectangleShape> gameBoard;
+    // Every fill first, then every outline, all drawn with a single draw call
+    sf::VertexArray m_vertices;
+    sf::Vector2f m_cellPositions[CELL_COUNT];
+    sf::Color m_cellColors[CELL_COUNT];
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+// Board size and line length as compile time constants. Every table the rules read is built by a constexpr
+// function when the geometry is instantiated, so a 6x6 or 7x7 variant is one more BoardGeometry<W, H, L>
+// and no code changes. Cells are numbered col * H + row, which is a [W][H] board array flattened.
+namespace BoardGeometryDetail {
+
+// std::mt19937_64 as a constexpr generator, so the compile time Zobrist keys are the ones the runtime table
+// used to draw from std::mt19937_64(12345) and hashes stay the same
+class Mt19937_64
+{
+public:
+    constexpr explicit Mt19937_64(uint64_t seed)
+        : m_state()
+        , m_index(STATE_SIZE)
+    {
+        m_state[0] = seed;
+        for (int i = 1; i < STATE_SIZE; i++) {
+            m_state[i] = 6364136223846793005ull * (m_state[i - 1] ^ (m_state[i - 1] >> 62)) + (uint64_t)i;
+        }
+    }
+
+    constexpr uint64_t operator()()
+    {
+        if (m_index >= STATE_SIZE) twist();
+        uint64_t y = m_state[m_index++];
+        y ^= (y >> 29) & 0x5555555555555555ull;
+        y ^= (y << 17) & 0x71D67FFFEDA60000ull;
+        y ^= (y << 37) & 0xFFF7EEE000000000ull;
+        return y ^ (y >> 43);
+    }
+
+private:
+    static constexpr int STATE_SIZE = 312;
+
+    constexpr void twist()
+    {
+        for (int i = 0; i < STATE_SIZE; i++) {
+            uint64_t x = (m_state[i] & 0xFFFFFFFF80000000ull) | (m_state[(i + 1) % STATE_SIZE] & 0x7FFFFFFFull);
+            m_state[i] = m_state[(i + 156) % STATE_SIZE] ^ (x >> 1) ^ ((x & 1) ? 0xB5026F5AA96619E9ull : 0);
+        }
+        m_index = 0;
+    }
+
+    uint64_t m_state[STATE_SIZE];
+    int m_index;
+};
+
+constexpr int lineCount(int w, int h, int l)
+{
+    // Horizontal, vertical, then both diagonals
+    return (w - l + 1) * h + w * (h - l + 1) + 2 * (w - l + 1) * (h - l + 1);
+}
+
+// The winning lines as cells and as a bit per cell, and the lines through each square
+template <int W, int H, int L, typename Mask>
+struct LineTable {
+    static constexpr int COUNT = lineCount(W, H, L);
+    static constexpr int MAX_PER_SQUARE = 4 * L; // at most L lines per direction pass through a square
+
+    uint8_t cells[COUNT][L] = {};
+    Mask masks[COUNT] = {};
+    uint8_t squareLineCount[W * H] = {};
+    uint8_t squareLines[W * H][MAX_PER_SQUARE] = {};
+};
+
+// Squares one step away, in the order move generation has always tried the directions
+template <int W, int H>
+struct StepTable {
+    uint8_t count[W * H] = {};
+    uint8_t cells[W * H][8] = {};
+};
+
+// From each square, the squares along each of the 8 directions up to the edge, for the frog's jumps
+template <int W, int H>
+struct RayTable {
+    static constexpr int MAX_LENGTH = (W > H ? W : H) - 1;
+
+    uint8_t length[W * H][8] = {};
+    uint8_t cells[W * H][8][MAX_LENGTH] = {};
+};
+
+constexpr int ORTHOGONAL_DIRECTIONS[4][2] = { {0,1},{0,-1},{1,0},{-1,0} };
+constexpr int ALL_DIRECTIONS[8][2] = { {-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1} };
+
+template <int W, int H, int L, typename Mask>
+constexpr LineTable<W, H, L, Mask> makeLineTable()
+{
+    LineTable<W, H, L, Mask> t{};
+    int line = 0;
+    auto add = [&t, &line](int col, int row, int dCol, int dRow) {
+        for (int i = 0; i < L; i++) {
+            int cell = (col + i * dCol) * H + row + i * dRow;
+            t.cells[line][i] = (uint8_t)cell;
+            t.masks[line] |= (Mask)1 << cell;
+            t.squareLines[cell][t.squareLineCount[cell]++] = (uint8_t)line;
+        }
+        line++;
+    };
+
+    for (int row = 0; row < H; row++) {
+        for (int col = 0; col + L <= W; col++) add(col, row, 1, 0);
+    }
+    for (int col = 0; col < W; col++) {
+        for (int row = 0; row + L <= H; row++) add(col, row, 0, 1);
+    }
+    for (int row = 0; row + L <= H; row++) {
+        for (int col = 0; col + L <= W; col++) add(col, row, 1, 1);
+    }
+    for (int row = 0; row + L <= H; row++) {
+        for (int col = L - 1; col < W; col++) add(col, row, -1, 1);
+    }
+    return t;
+}
+
+template <int W, int H, int N>
+constexpr StepTable<W, H> makeStepTable(const int (&directions)[N][2])
+{
+    StepTable<W, H> t{};
+    for (int col = 0; col < W; col++) {
+        for (int row = 0; row < H; row++) {
+            int cell = col * H + row;
+            for (int d = 0; d < N; d++) {
+                int toCol = col + directions[d][0], toRow = row + directions[d][1];
+                if (toCol >= 0 && toCol < W && toRow >= 0 && toRow < H) {
+                    t.cells[cell][t.count[cell]++] = (uint8_t)(toCol * H + toRow);
+                }
+            }
+        }
+    }
+    return t;
+}
+
+// Most neighbours any square has in the table
+template <int W, int H>
+constexpr int maxStepCount(const StepTable<W, H>& t)
+{
+    int most = 0;
+    for (int cell = 0; cell < W * H; cell++) {
+        if (t.count[cell] > most) most = t.count[cell];
+    }
+    return most;
+}
+
+template <int W, int H>
+constexpr RayTable<W, H> makeRayTable()
+{
+    RayTable<W, H> t{};
+    for (int col = 0; col < W; col++) {
+        for (int row = 0; row < H; row++) {
+            int cell = col * H + row;
+            for (int d = 0; d < 8; d++) {
+                int toCol = col + ALL_DIRECTIONS[d][0], toRow = row + ALL_DIRECTIONS[d][1];
+                while (toCol >= 0 && toCol < W && toRow >= 0 && toRow < H) {
+                    t.cells[cell][d][t.length[cell][d]++] = (uint8_t)(toCol * H + toRow);
+                    toCol += ALL_DIRECTIONS[d][0];
+                    toRow += ALL_DIRECTIONS[d][1];
+                }
+            }
+        }
+    }
+    return t;
+}
+
+// [cell][PieceType][owner, 0 player 1 AI]
+template <int CELLS>
+struct ZobristTable {
+    uint64_t keys[CELLS][3][2] = {};
+};
+
+template <int CELLS>
+constexpr ZobristTable<CELLS> makeZobristTable()
+{
+    ZobristTable<CELLS> t{};
+    Mt19937_64 rng(12345);
+    for (int cell = 0; cell < CELLS; cell++) {
+        for (int type = 0; type < 3; type++) {
+            for (int owner = 0; owner < 2; owner++) {
+                t.keys[cell][type][owner] = rng();
+            }
+        }
+    }
+    return t;
+}
+
+} // namespace BoardGeometryDetail
+
+template <int W, int H, int L>
+struct BoardGeometry {
+    static_assert(W >= L && H >= L && L >= 2, "lines must fit on the board");
+    static_assert(W * H <= 64, "squares are bits of a 64 bit mask");
+
+    static constexpr int WIDTH = W;
+    static constexpr int HEIGHT = H;
+    static constexpr int LINE_LENGTH = L;
+    static constexpr int CELLS = W * H;
+    static constexpr int LINE_COUNT = BoardGeometryDetail::lineCount(W, H, L);
+
+    // Bit per square, as narrow as the board allows
+    using Mask = std::conditional_t<(CELLS <= 32), uint32_t, uint64_t>;
+
+    static constexpr int cell(int col, int row) { return col * H + row; }
+    static constexpr int columnOf(int cell) { return cell / H; }
+    static constexpr int rowOf(int cell) { return cell % H; }
+    static constexpr bool contains(int col, int row) { return col >= 0 && col < W && row >= 0 && row < H; }
+
+    static constexpr BoardGeometryDetail::LineTable<W, H, L, Mask> LINES =
+        BoardGeometryDetail::makeLineTable<W, H, L, Mask>();
+    static constexpr BoardGeometryDetail::StepTable<W, H> ORTHOGONAL_STEPS =
+        BoardGeometryDetail::makeStepTable<W, H>(BoardGeometryDetail::ORTHOGONAL_DIRECTIONS);
+    static constexpr BoardGeometryDetail::StepTable<W, H> KING_STEPS =
+        BoardGeometryDetail::makeStepTable<W, H>(BoardGeometryDetail::ALL_DIRECTIONS);
+    static constexpr BoardGeometryDetail::RayTable<W, H> RAYS = BoardGeometryDetail::makeRayTable<W, H>();
+    static constexpr BoardGeometryDetail::ZobristTable<CELLS> ZOBRIST =
+        BoardGeometryDetail::makeZobristTable<CELLS>();
+
+    // The 8 symmetries of a square board: identity, rotate 90, 180, 270, mirror left-right, mirror top-bottom,
+    // main diagonal, anti diagonal. A rectangular board only has 0, 2, 4 and 5.
+    static constexpr bool SQUARE = W == H;
+    static constexpr void transformSquare(int symmetry, int col, int row, int& outCol, int& outRow)
+    {
+        switch (symmetry) {
+        case 0: outCol = col;         outRow = row;         break;
+        case 1: outCol = W - 1 - row; outRow = col;         break;
+        case 2: outCol = W - 1 - col; outRow = H - 1 - row; break;
+        case 3: outCol = row;         outRow = H - 1 - col; break;
+        case 4: outCol = W - 1 - col; outRow = row;         break;
+        case 5: outCol = col;         outRow = H - 1 - row; break;
+        case 6: outCol = row;         outRow = col;         break;
+        default: outCol = W - 1 - row; outRow = H - 1 - col; break;
+        }
+    }
+};
+
+// The game as it is played today, and the larger variants
+using StandardGeometry = BoardGeometry<5, 5, 4>;
+using Geometry6x6 = BoardGeometry<6, 6, 4>;
+using Geometry7x7 = BoardGeometry<7, 7, 4>;
+
+static_assert(StandardGeometry::LINE_COUNT == 28, "the 5x5 board has 28 four in a row lines");
+static_assert(StandardGeometry::LINES.squareLineCount[StandardGeometry::cell(2, 2)] == 8, "centre square");
+static_assert(Geometry6x6::LINE_COUNT == 54, "the 6x6 board has 54 four in a row lines");
+static_assert(Geometry6x6::LINES.squareLineCount[Geometry6x6::cell(2, 2)] == 11, "inner square");
+static_assert(std::is_same_v<Geometry6x6::Mask, uint64_t>, "36 squares need the 64 bit mask");
+static_assert(Geometry7x7::LINE_COUNT == 88, "the 7x7 board has 88 four in a row lines");
+static_assert(Geometry7x7::LINES.squareLineCount[Geometry7x7::cell(3, 3)] == 16, "centre square");
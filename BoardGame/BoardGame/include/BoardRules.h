@@ -0,0 +1,150 @@
+#pragma once
+
+#include "BoardGeometry.h"
+#include "Piece.h"
+#include <cstdlib>
+
+// Represents a move in the game
+struct Move {
+    int fromCol;
+    int fromRow;
+    int toCol;
+    int toRow;
+    Piece* piece;
+
+    Move() : fromCol(-1), fromRow(-1), toCol(-1), toRow(-1), piece(nullptr) {}
+    Move(int fc, int fr, int tc, int tr, Piece* p)
+        : fromCol(fc), fromRow(fr), toCol(tc), toRow(tr), piece(p) {
+    }
+};
+
+// The rules of the movement phase for any BoardGeometry, over a board of Geometry::CELLS piece pointers
+// indexed by Geometry::cell. Everything is driven by the geometry's constexpr tables, so the compiler sees
+// the board size as a constant in every loop. GameState is the 5x5 front end over BoardRules<StandardGeometry>.
+template <typename Geometry>
+class BoardRules
+{
+public:
+    using Mask = typename Geometry::Mask;
+
+    // Most moves one side can have: the frog's steps plus a jump per direction, the snake's steps and three
+    // donkeys' steps, each from the square the geometry gives the most room
+    static constexpr int MAX_MOVES = 3 * BoardGeometryDetail::maxStepCount(Geometry::KING_STEPS)
+        + 3 * BoardGeometryDetail::maxStepCount(Geometry::ORTHOGONAL_STEPS);
+
+    // Donkeys step orthogonally, snakes one square any way, frogs step like snakes or jump along a line over
+    // an unbroken run of pieces to the first empty square after it. Out must hold MAX_MOVES. Returns the move
+    // count.
+    static int generateMoves(Piece* const* board, PieceOwner player, Move* out)
+    {
+        int count = 0;
+
+        for (int from = 0; from < Geometry::CELLS; from++) {
+            Piece* piece = board[from];
+            if (!piece || piece->getOwner() != player) continue;
+
+            int fromCol = Geometry::columnOf(from), fromRow = Geometry::rowOf(from);
+            const auto& steps = piece->getType() == PieceType::DONKEY ? Geometry::ORTHOGONAL_STEPS : Geometry::KING_STEPS;
+            for (int i = 0; i < steps.count[from]; i++) {
+                int to = steps.cells[from][i];
+                if (!board[to]) out[count++] = Move(fromCol, fromRow, Geometry::columnOf(to), Geometry::rowOf(to), piece);
+            }
+
+            if (piece->getType() != PieceType::FROG) continue;
+            for (int d = 0; d < 8; d++) {
+                const uint8_t* ray = Geometry::RAYS.cells[from][d];
+                int length = Geometry::RAYS.length[from][d];
+                if (length == 0 || !board[ray[0]]) continue;
+
+                int landing = 1;
+                while (landing < length && board[ray[landing]]) landing++;
+                if (landing < length) {
+                    int to = ray[landing];
+                    out[count++] = Move(fromCol, fromRow, Geometry::columnOf(to), Geometry::rowOf(to), piece);
+                }
+            }
+        }
+
+        return count;
+    }
+
+    // Bit per square holding one of the player's pieces, so line checks are mask compares
+    static Mask ownerMask(Piece* const* board, PieceOwner player)
+    {
+        Mask mask = 0;
+        for (int cell = 0; cell < Geometry::CELLS; cell++) {
+            if (board[cell] && board[cell]->getOwner() == player) mask |= (Mask)1 << cell;
+        }
+        return mask;
+    }
+
+    static bool isWinning(Piece* const* board, PieceOwner player)
+    {
+        return isWinning(ownerMask(board, player));
+    }
+
+    static bool isWinning(Mask own)
+    {
+        for (int line = 0; line < Geometry::LINE_COUNT; line++) {
+            if ((own & Geometry::LINES.masks[line]) == Geometry::LINES.masks[line]) return true;
+        }
+        return false;
+    }
+
+    // Own pieces on a line the opponent has no piece on, 0 when the opponent has one
+    static int openLineCount(Mask own, Mask opponent, int line)
+    {
+        Mask mask = Geometry::LINES.masks[line];
+        if (opponent & mask) return 0;
+        int count = 0;
+        for (Mask bits = own & mask; bits; bits &= bits - 1) count++;
+        return count;
+    }
+
+    // Whether a piece of this type could move between the cells on this board
+    static bool canReach(Piece* const* board, PieceType type, int fromCell, int toCell)
+    {
+        int fromCol = Geometry::columnOf(fromCell), fromRow = Geometry::rowOf(fromCell);
+        int dCol = Geometry::columnOf(toCell) - fromCol, dRow = Geometry::rowOf(toCell) - fromRow;
+        int distance = std::abs(dCol) > std::abs(dRow) ? std::abs(dCol) : std::abs(dRow);
+
+        switch (type) {
+        case PieceType::DONKEY: return std::abs(dCol) + std::abs(dRow) == 1;
+        case PieceType::SNAKE: return distance == 1;
+        case PieceType::FROG: {
+            // Steps or jumps along any of the 8 directions, a jump needs every square it passes over occupied
+            if (dCol != 0 && dRow != 0 && std::abs(dCol) != std::abs(dRow)) return false;
+            int stepCol = (dCol > 0) - (dCol < 0), stepRow = (dRow > 0) - (dRow < 0);
+            for (int i = 1; i < distance; i++) {
+                if (!board[Geometry::cell(fromCol + i * stepCol, fromRow + i * stepRow)]) return false;
+            }
+            return true;
+        }
+        default: return false;
+        }
+    }
+
+    // True when the player can complete a line with their next move
+    static bool hasWinningMove(Piece* const* board, PieceOwner player)
+    {
+        for (int line = 0; line < Geometry::LINE_COUNT; line++) {
+            int own = 0, emptyCell = -1;
+            for (int cell : Geometry::LINES.cells[line]) {
+                Piece* p = board[cell];
+                if (!p) emptyCell = cell;
+                else if (p->getOwner() == player) own++;
+            }
+            if (own != Geometry::LINE_LENGTH - 1 || emptyCell < 0) continue;
+
+            // Any of the player's pieces off the line that can get to the gap completes it
+            for (int cell = 0; cell < Geometry::CELLS; cell++) {
+                Piece* p = board[cell];
+                if (!p || p->getOwner() != player || (Geometry::LINES.masks[line] & ((Mask)1 << cell))) continue;
+                if (canReach(board, p->getType(), cell, emptyCell)) return true;
+            }
+        }
+        return false;
+    }
+};
+
+static_assert(BoardRules<StandardGeometry>::MAX_MOVES == 36, "frog 16, snake 8, three donkeys 4 each");
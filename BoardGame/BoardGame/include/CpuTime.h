@@ -0,0 +1,4 @@
+#pragma once
+
+// CPU time used by this process so far (all threads, user + kernel), in seconds
+double getProcessCpuSeconds();
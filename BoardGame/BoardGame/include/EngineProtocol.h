@@ -0,0 +1,76 @@
+#pragma once
+
+#include "GameState.h"
+#include "MiniMax.h"
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Line based text protocol on stdin/stdout so GUIs and scripts can drive the engine, in the spirit of UCI.
+// Squares, moves and boards are written as in Notation.h, placements as piece@square ("F@c3", or just
+// "c3" for the next piece in the usual Frog, Snake, Donkey order).
+//
+//   newgame                                  empty board, player to place first
+//   position startpos [moves <m>...]         same, then play the listed placements/moves
+//   position board <25 chars> [turn player|ai] [moves <m>...]
+//   place <p>... / move <m>...               play for the side to move
+//   go [depth N] [movetime ms] [nodes N] [multipv K] [infinite] [deterministic]
+//                                            prints "info depth .. score .. nodes .. nps .. time .. pv .."
+//                                            per finished depth (one per line with "multipv i" when K > 1,
+//                                            in the engine's order rather than by score, see RootLine),
+//                                            then "bestmove <m>" or "bestmove none", with infinite only
+//                                            once stop arrives even if the search ended. deterministic gives the
+//                                            same result on every machine (SearchLimits::deterministic); it
+//                                            ignores movetime and infinite and searches the default depth
+//                                            unless given a depth or nodes.
+//   stop / isready / d / quit
+//
+// One process serves any number of searches; engines and their hash tables live as long as it does.
+class EngineProtocol
+{
+public:
+    EngineProtocol(std::istream& in, std::ostream& out, int defaultDepth = 3);
+    ~EngineProtocol();
+
+    // Reads commands until quit or end of input
+    int run();
+
+private:
+    bool handleCommand(const std::string& line); // false on quit
+    void newGame();
+    bool setBoard(const std::string& board);
+    bool playTokens(std::istringstream& tokens, bool placementsOnly, bool movesOnly);
+    bool playToken(const std::string& token);
+    bool playPlacement(PieceType type, int col, int row);
+    bool playMove(int fromCol, int fromRow, int toCol, int toRow);
+    void nextTurn();
+    void startSearch(std::istringstream& tokens);
+    void stopSearch();
+    void printBoard();
+
+    Piece* findUnplaced(PieceOwner owner, PieceType type) const;
+    PieceType nextPlacementType(PieceOwner owner) const;
+    int countPlaced() const;
+    MiniMax& engineFor(PieceOwner side) { return side == PieceOwner::PLAYER ? m_playerEngine : m_aiEngine; }
+
+    void send(const std::string& line);
+
+    std::istream& m_in;
+    std::ostream& m_out;
+    int m_defaultDepth;
+
+    std::vector<std::unique_ptr<Piece>> m_pieces; // headless, 5 per side
+    GameState m_state;
+    PieceOwner m_sideToMove;
+    MiniMax m_playerEngine;
+    MiniMax m_aiEngine;
+
+    std::thread m_searchThread;
+    std::atomic<bool> m_stop;
+    std::mutex m_outputMutex; // info lines come from the search thread
+};
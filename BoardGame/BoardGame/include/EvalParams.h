@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+
+// Tunable weights used by GameState::evaluate and MiniMax::evaluatePosition.
+// Defaults are the original hand picked values; the tuner (--tune) writes a file that replaces them at startup.
+struct EvalParams
+{
+    // GameState::evaluateLine, open lines with 3/2/1 of our pieces
+    int lineThree = 150;
+    int lineTwo = 20;
+    int lineOne = 2;
+
+    // GameState::evaluate
+    int offenseWeight = 15;
+    int defenseWeight = 20;
+    int centerWeight = 3;
+    int centerValues[5][5] = {
+        {1, 2, 3, 2, 1},
+        {2, 4, 5, 4, 2},
+        {3, 5, 8, 5, 3},
+        {2, 4, 5, 4, 2},
+        {1, 2, 3, 2, 1}
+    };
+
+    // MiniMax::evaluatePosition (placement heuristic)
+    int placementCenterWeight = 8;
+    int friendlyNeighborWeight = 12;
+    int opponentNeighborWeight = 8;
+    int blockingWeight = 25;
+    int offensiveWeight = 15;
+    int placementValues[5][5] = {
+        {2, 3, 4, 3, 2},
+        {3, 5, 6, 5, 3},
+        {4, 6, 10, 6, 4},
+        {3, 5, 6, 5, 3},
+        {2, 3, 4, 3, 2}
+    };
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Weights the engine uses unless a search is given its own set
+    static EvalParams& active();
+
+    static constexpr const char* DEFAULT_PATH = "ASSETS/DATA/engine.params";
+};
@@ -6,9 +6,13 @@
 #include "Board.h"
 #include "GameState.h"
 #include "MiniMax.h"
+#include "OpeningBook.h"
+#include "GameRecord.h"
 #include "Donkey.h"
 #include "Snake.h"
 #include "Frog.h"
+#include "TextureAtlas.h"
+#include "AssetLoader.h"
 
 #include <vector>
 
@@ -24,6 +28,13 @@ public:
     ~Game();
     void run();
 
+    // Appends each finished game to a record file
+    void setRecordFile(const std::string& path);
+
+    // On by default: only redraw when something changed and block on events while idle.
+    // Off restores the old render-every-pass loop, useful for comparing CPU use.
+    void setEventDrivenRendering(bool enabled) { m_eventDriven = enabled; }
+
 private:
     // Init game
     void initializePieces(); //create game pieces
@@ -31,6 +42,8 @@ private:
 
     // Game loop
     void processEvents();
+    void handleEvent(const sf::Event& event);
+    sf::Time getIdleWait() const; // how long the loop may sleep waiting for input, zero when there is work now
     void processKeys(const std::optional<sf::Event> t_event);
     void checkKeyboardState();
     void update(sf::Time t_deltaTime);
@@ -61,11 +74,38 @@ private:
     void switchTurn();
     void renderModeSelection();
 
+    // Background asset loading
+    void startAssetLoading();
+    void checkAssetsLoaded(); // finishes on the main thread once the loader is done
+    void renderLoadingProgress();
+
+    // Game record
+    void recordStats(const MiniMax* engine, int depth, sf::Time elapsed); // engine is null for human plies
+    void writeRecord(GameResult result);
+
     // Game Comps
+    sf::Clock m_startupClock; // first member so it covers window creation, for time to first frame
     Board m_board;
     GameState m_gameState;
     MiniMax m_ai{ PieceOwner::AI }; // ai
     MiniMax m_playerAI{ PieceOwner::PLAYER }; //ai as player
+    OpeningBook m_openingBook; // placement book shared by both AIs
+    GameRecordWriter m_recordWriter;
+    GameRecord m_record;
+    bool m_recordWritten = false;
+
+    // Dirty flag rendering
+    struct LoopStats {
+        double wallSeconds = 0.0;
+        double cpuSeconds = 0.0;
+        int frames = 0;
+    };
+    void printLoopStats(const char* name, const LoopStats& stats) const;
+
+    bool m_eventDriven = true;
+    bool m_needsRedraw = true;
+    LoopStats m_idleStats;   // waiting for the human or the menu
+    LoopStats m_activeStats; // AI thinking or AI vs AI playing
 
     // General SFML and locals
     sf::RenderWindow window;
@@ -80,6 +120,8 @@ private:
     bool m_waitingForNextMove;
 
     // Pieces
+    TextureAtlas m_pieceAtlas;  // one texture holding every piece image
+    sf::VertexArray m_pieceBatch{ sf::PrimitiveType::Triangles }; // rebuilt each render, one draw call
     std::vector<std::unique_ptr<Piece>> m_allPieces;
     std::vector<Piece*> m_playerPieces;
     std::vector<Piece*> m_aiPieces;
@@ -92,6 +134,12 @@ private:
 
     int m_playerPiecesPlaced;
     int m_aiPiecesPlaced;
+
+    // Assets, decoded in the background while the menu is already showing
+    bool m_assetsReady = false;
+    bool m_firstFrameShown = false;
+    int m_loadingShown = -1; // completed job count last drawn
+    AssetLoader m_assetLoader; // last so its workers are joined before anything they write to is destroyed
 };
 
 #pragma warning( pop ) 
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "GameState.h"
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Search numbers for one ply, only stored when a game was played by engines
+struct PlyStats {
+    uint8_t depth = 0;
+    int32_t score = 0;
+    uint32_t nodes = 0;
+    uint32_t timeMicros = 0;
+};
+
+// One finished game. Placements alternate owners starting with the player, same for moves.
+// Cells are col * 5 + row.
+struct GameRecord {
+    struct Placement {
+        uint8_t cell;
+        PieceType type;
+    };
+
+    struct RecordedMove {
+        uint8_t fromCell; // PASS_CELL for both when the side had no legal move
+        uint8_t toCell;
+    };
+
+    static constexpr uint8_t PASS_CELL = 255;
+
+    GameResult result = GameResult::DRAW;
+    std::vector<Placement> placements;
+    std::vector<RecordedMove> moves;
+    std::vector<PlyStats> stats; // empty, or one entry per placement then one per move
+
+    void clear();
+    void addPlacement(int col, int row, PieceType type);
+    void addMove(const Move& move);
+    void addPass();
+    int plies() const { return (int)(placements.size() + moves.size()); }
+};
+
+// Appends games to a record file. File layout:
+//   "BGGR", u8 version, 3 reserved bytes
+//   per game: varint payload size, then
+//     u8 result, u8 flags (bit 0 = has stats), u8 placement count, varint move count,
+//     1 byte per placement (cell | type << 5), 2 bytes per move (from, to),
+//     per ply stats when flagged: u8 depth, zigzag varint score, varint nodes, varint micros
+// Safe to share between threads, each game is written and flushed as one block.
+class GameRecordWriter
+{
+public:
+    GameRecordWriter();
+
+    bool open(const std::string& path); // appends if the file already holds games
+    bool isOpen() const { return m_file.is_open(); }
+    void close();
+
+    bool write(const GameRecord& record);
+    size_t getGamesWritten() const { return m_gamesWritten; }
+
+private:
+    std::ofstream m_file;
+    std::mutex m_mutex;
+    std::vector<uint8_t> m_buffer;
+    size_t m_gamesWritten;
+};
+
+// Streams games back out of a record file one at a time
+class GameRecordReader
+{
+public:
+    bool open(const std::string& path);
+    bool isOpen() const { return m_file.is_open(); }
+
+    // False at end of file, or when the next game is truncated or damaged
+    bool next(GameRecord& record);
+
+private:
+    bool decode(GameRecord& record) const;
+
+    std::ifstream m_file;
+    std::vector<uint8_t> m_buffer;
+};
+
+namespace GameRecordFormat {
+    constexpr char MAGIC[4] = { 'B', 'G', 'G', 'R' };
+    constexpr uint8_t VERSION = 1;
+    constexpr uint8_t FLAG_STATS = 1;
+    constexpr uint32_t MAX_PAYLOAD = 1 << 20;
+}
@@ -1,26 +1,15 @@
 #pragma once
 
 #include "Piece.h"
+#include "BoardRules.h"
+#include "EvalParams.h"
+#include "NeuralNet.h"
 #include <vector>
 #include <limits>
 #include <unordered_map>
 #include <string>
 #include <random>
 
-// Represents a move in the game
-struct Move {
-    int fromCol;
-    int fromRow;
-    int toCol;
-    int toRow;
-    Piece* piece;
-
-    Move() : fromCol(-1), fromRow(-1), toCol(-1), toRow(-1), piece(nullptr) {}
-    Move(int fc, int fr, int tc, int tr, Piece* p)
-        : fromCol(fc), fromRow(fr), toCol(tc), toRow(tr), piece(p) {
-    }
-};
-
 // Game phases
 enum class GamePhase {
     PLACEMENT,
@@ -28,8 +17,20 @@ enum class GamePhase {
     GAME_OVER
 };
 
+// How a finished game ended, UNFINISHED for a GUI game closed before anyone won
+enum class GameResult {
+    PLAYER_WIN,
+    AI_WIN,
+    DRAW,
+    UNFINISHED
+};
+
 class GameState {
 public:
+    // The board this game is played on, BoardGeometry has the 6x6 and 7x7 variants' tables
+    using Geometry = StandardGeometry;
+    using Rules = BoardRules<Geometry>;
+
     GameState();
     ~GameState();
 
@@ -44,11 +45,21 @@ public:
     bool isValidMove(const Move& move) const;
 
     std::vector<Move> getLegalMoves(PieceOwner player) const;
+
+    // Allocation free move generation for the search, out must hold MAX_MOVES. Returns the move count.
+    // Rules::MAX_MOVES (36) at most, with room to spare
+    static constexpr int MAX_MOVES = 48;
+    static_assert(MAX_MOVES >= Rules::MAX_MOVES, "room for every move the rules can generate");
+    int generateMoves(PieceOwner player, Move* out) const;
     std::vector<std::pair<int, int>> getLegalPlacements() const;
 
     // Move execution
     void applyMove(const Move& move, bool updatePiecePosition = true);
-    void applyPlacement(int col, int row, Piece* piece);
+    void applyPlacement(int col, int row, Piece* piece, bool updatePiecePosition = true);
+    void undoMove(const Move& move); // reverses applyMove(move, false) during search
+
+    // Copies the board, phase and hash but not the repetition history, so a search copy never allocates
+    void copyPosition(const GameState& other);
 
     // Win condition checking
     bool isWinningState(PieceOwner player) const;
@@ -56,6 +67,41 @@ public:
 
     // Evaluation for AI
     int evaluate(PieceOwner player) const;
+    int evaluate(PieceOwner player, const EvalParams& params) const;
+
+    // Optional evaluation network. While one is set its first layer sums follow applyMove, applyPlacement and
+    // undoMove; like the hash they don't follow setPieceAt/removePieceAt. evaluateNetwork needs one set.
+    void setNetwork(const NeuralNet* network);
+    const NeuralNet* getNetwork() const { return m_network; }
+    int evaluateNetwork(PieceOwner player) const { return m_network->evaluate(m_accumulator, player); }
+
+    // What a move does to the lines through the two squares it touches, as MoveTactic flags.
+    // Selective search only reduces or prunes quiet moves, threat search only plays the forcing ones.
+    enum MoveTactic {
+        TACTIC_NONE = 0,
+        TACTIC_FOUR = 1,    // completes four in a row
+        TACTIC_THREE = 2,   // three in a line the opponent has no piece on
+        TACTIC_BLOCK = 4,   // lands on the empty square of an opponent three
+        TACTIC_UNBLOCK = 8, // leaves one, letting an opponent three through
+        TACTIC_BREAK = 16   // takes a piece out of its own three
+    };
+    static constexpr int FORCING_TACTICS = TACTIC_FOUR | TACTIC_THREE | TACTIC_BLOCK;
+    int getMoveTactics(const Move& move) const;
+    bool isQuietMove(const Move& move) const { return getMoveTactics(move) == TACTIC_NONE; }
+
+    // True when the player can complete four in a row with their next move
+    bool hasWinningMove(PieceOwner player) const;
+    // Narrows a generated move list in place when the position forces it: to the winning moves if there are
+    // any, otherwise to the moves that leave the opponent no win next turn. Returns the new count, which is
+    // the old one when nothing is forced or every move loses anyway.
+    int filterForcedMoves(PieceOwner player, Move* moves, int count);
+
+    // The 28 four in a row lines as a bit per square, bit col * 5 + row
+    static constexpr int LINE_COUNT = Geometry::LINE_COUNT;
+    static Geometry::Mask getLineMask(int line) { return Geometry::LINES.masks[line]; }
+
+    // Open line counts (lines with no opponent piece) holding 3/2/1 of the player's pieces, used by the tuner
+    void getLineCounts(PieceOwner player, int& threes, int& twos, int& ones) const;
 
     // Game phase management
     GamePhase getCurrentPhase() const { return m_currentPhase; }
@@ -68,22 +114,33 @@ public:
     int getPositionRepetitionCount(uint64_t key) const;
     void clearPositionHistory();
 
+    // Board symmetries (rotations/reflections of the 5x5 square) for symmetry reduced lookups
+    static_assert(Geometry::SQUARE, "the 8 symmetries need a square board");
+    static constexpr int SYMMETRY_COUNT = 8;
+    static void transformSquare(int symmetry, int col, int row, int& outCol, int& outRow)
+    {
+        Geometry::transformSquare(symmetry, col, row, outCol, outRow);
+    }
+    static int inverseSymmetry(int symmetry);
+    uint64_t getCanonicalHash(int* symmetryOut = nullptr) const; // smallest hash over all 8 symmetries
+
 private:
     // Add non owning pointer to board and the locals
-    Piece* m_board[5][5];
+    Piece* m_board[Geometry::WIDTH][Geometry::HEIGHT];
     GamePhase m_currentPhase;
     PieceOwner m_currentPlayer;
     PieceOwner m_winner;
 
     // Position history tracking
-    void initializeZobrist();
     std::unordered_map<uint64_t, int> m_positionHistory;
     uint64_t m_zobristKey;
 
-    // To check a line directly
-    bool checkLine(int startCol, int startRow, int dCol, int dRow, PieceOwner player) const;
+    const NeuralNet* m_network;
+    NeuralNet::Accumulator m_accumulator;
+
+    Piece* const* cells() const { return &m_board[0][0]; }
     // Helper functions for evaluation
-    int evaluateLines(PieceOwner player) const;
-    int evaluateLine(int startCol, int startRow, int deltaCol, int deltaRow, PieceOwner player) const;
-    int evaluateCenterControl(PieceOwner player) const;
+    int evaluateLines(Geometry::Mask own, Geometry::Mask opponent, const EvalParams& params) const;
+    int evaluateLine(int line, Geometry::Mask own, Geometry::Mask opponent, const EvalParams& params) const;
+    int evaluateCenterControl(Geometry::Mask own, const EvalParams& params) const;
 };
\ No newline at end of file
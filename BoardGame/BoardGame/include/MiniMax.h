@@ -1,9 +1,76 @@
 #pragma once
 
 #include "GameState.h"
+#include "SearchArena.h"
+#include "SearchStats.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <limits>
+#include <memory>
 #include <vector>
 
+class OpeningBook;
+
+// Inputs of the placement heuristic for one square, before weighting
+struct PlacementFeatures {
+    int evalAfter;          // board evaluation once the piece is placed
+    int friendlyNeighbors;
+    int opponentNeighbors;
+    int blocking;
+    int offensive;
+};
+
+// Limits for MiniMax::search, zero means unlimited. With no depth, time, nodes or stop flag the search
+// runs to the maximum depth.
+struct SearchLimits {
+    int depth = 0;
+    int64_t timeMs = 0;
+    uint64_t nodes = 0;
+    const std::atomic<bool>* stop = nullptr; // set from another thread to end the search early
+    int lines = 1;                           // root moves to score exactly, more than one for multi-PV analysis
+
+    // Same move, score and node count for the same position and limits on every machine and run, for
+    // regression tests and bench comparisons. The search starts from an empty private hash table and history
+    // and ignores timeMs, so give it a depth or a node budget. stop still ends it, with a result that is not
+    // reproducible.
+    bool deterministic = false;
+};
+
+// One finished iteration of MiniMax::search. pv points into the engine and is only valid during the callback.
+struct SearchInfo {
+    int depth;
+    int score;
+    uint64_t nodes;
+    uint64_t micros;
+    const Move* pv;
+    int pvLength;
+    int line = 0; // multi-PV rank, 0 for the best move
+};
+
+// One root move of the last finished iteration with its exact score and line. Lines come in the order the
+// engine prefers the moves, the first being the move search returns. That is not always score order: each line
+// passes over moves that repeat a position while it has another, so a later line can score higher.
+struct RootLine {
+    Move move;
+    int score = 0;
+    std::vector<Move> pv;
+};
+
+// Selective search switches, all on by default. Turning them off gives the full width search for comparisons.
+struct SearchFeatures {
+    bool lateMoveReductions = true; // late quiet moves one or two plies shallower, re-searched if they look good
+    bool futilityPruning = true;    // quiet moves skipped one ply from the leaves when the node is far below the window
+    bool razoring = true;           // the same two plies from the leaves, checked with a one ply search first
+    bool threatSearch = true;       // forcing moves played on past depth 0 (quiescence) instead of stopping dead
+    bool forcedMoves = true;        // only winning moves, or moves that stop every opponent win, where there are any
+
+    // Quiet moves change the evaluation by under ~1000 in 99% of positions and never by more than ~2400
+    int futilityMargin = 1100;
+    int razorMargin = 2400;
+};
+
 class MiniMax
 {
 public:
@@ -12,8 +79,52 @@ public:
     ~MiniMax();
 
     Move findBestMove(const GameState& state, int depth);
+
+    // Iterative deepening until a limit is hit, reporting each finished depth. A search cut short returns the
+    // best move of the last finished depth, the first depth always finishes.
+    Move search(const GameState& state, const SearchLimits& limits,
+        const std::function<void(const SearchInfo&)>& onIteration = nullptr);
+
+    // Best line of the last finished iteration, starting with the move search returned
+    std::vector<Move> getPrincipalVariation() const;
+    // All SearchLimits::lines root moves of the last finished iteration
+    const std::vector<RootLine>& getRootLines() const { return m_lines; }
     std::pair<int, int> findBestPlacement(const GameState& state, Piece* piece);
 
+    // Optional placement book, checked before the placement heuristic
+    void setOpeningBook(const OpeningBook* book) { m_openingBook = book; }
+
+    // Search logging to the console, off for headless self-play
+    void setVerbose(bool verbose) { m_verbose = verbose; }
+
+    // Weights for this engine, defaults to EvalParams::active(). Must outlive the engine.
+    void setEvalParams(const EvalParams* params) { m_params = params; clearHash(); }
+
+    // Evaluation network used instead of the line heuristic in the movement search, nullptr for the heuristic.
+    // Defaults to NeuralNet::getActive(). Must outlive the engine.
+    void setNetwork(const NeuralNet* network) { m_network = network; clearHash(); }
+    const NeuralNet* getNetwork() const { return m_network; }
+
+    void setSearchFeatures(const SearchFeatures& features) { m_features = features; clearHash(); }
+    const SearchFeatures& getSearchFeatures() const { return m_features; }
+
+    // Forget searched positions, e.g. for a new game. Results are kept between searches otherwise.
+    // A shared table (TTBackend) is left to the other engines using it, its keys carry the settings instead.
+    void clearHash() { if (!m_tt.isShared()) m_tt.clear(); }
+
+    // Writes this engine's table to a file, or merges one written before into it, to warm start analysis
+    bool saveHash(const std::string& path) const { return m_tt.save(path); }
+    bool loadHash(const std::string& path) { return m_tt.load(path); }
+
+    // Placement heuristic split into features and weights so the tuner can refit the weights
+    void getPlacementFeatures(const GameState& state, int col, int row, Piece* piece, PlacementFeatures& features) const;
+    static int scorePlacement(const PlacementFeatures& features, int col, int row, const EvalParams& params);
+
+    // Results of the last findBestMove/findBestPlacement call
+    const SearchStats& getSearchStats() const { return m_stats; }
+    int getNodesEvaluated() const { return (int)m_stats.nodes; }
+    int getLastScore() const { return m_stats.score; }
+
 private:
     // Evaluation
     int evaluatePosition(const GameState& state, int col, int row, Piece* piece);
@@ -21,14 +132,32 @@ private:
     int evaluateOffensivePotential(const GameState& state, int col, int row, Piece* piece) const;
 
     // Minimax algorithm
-    int alphaBeta(const GameState& state, int depth, int alpha, int beta,
-        bool isMaximizingPlayer, PieceOwner aiPlayer);
+    // Searches m_searchState, every move made is unmade before returning
+    int searchRoot(int depth, const Move* moves, const int* repetitions, int moveCount, Move& bestMove);
+
+    int alphaBeta(int depth, int ply, int alpha, int beta, bool isMaximizingPlayer, PieceOwner aiPlayer);
+
+    // pruneQuiet skips every quiet move after the first (futility pruning)
+    int maximizeScore(const Move* moves, int moveCount,
+        int depth, int ply, int alpha, int beta, PieceOwner aiPlayer, bool pruneQuiet, int& bestIndex);
 
-    int maximizeScore(const GameState& state, const std::vector<Move>& moves,
-        int depth, int alpha, int beta, PieceOwner aiPlayer);
+    int minimizeScore(const Move* moves, int moveCount,
+        int depth, int ply, int alpha, int beta, PieceOwner aiPlayer, bool pruneQuiet, int& bestIndex);
 
-    int minimizeScore(const GameState& state, const std::vector<Move>& moves,
-        int depth, int alpha, int beta, PieceOwner aiPlayer);
+    // Static score of m_searchState for aiPlayer, from the network when one is set
+    int staticEval(PieceOwner aiPlayer, bool aiToMove) const;
+    int quiescence(int ply, int qDepth, int alpha, int beta, bool isMaximizingPlayer, PieceOwner aiPlayer);
+
+    int reducedDepth(int depth, int moveIndex, bool quiet) const;
+    void orderMoves(Move* moves, int moveCount, PieceOwner side, uint8_t hashFrom, uint8_t hashTo) const;
+    void recordCutoff(const Move& move, PieceOwner side, int depth);
+
+    bool shouldAbort();
+    void updatePv(int ply, const Move& move);
+    int copyPv(const Move& rootMove, Move* out) const;
+    void extendPvFromHash(int depth);
+    uint64_t hashKey(const GameState& state, PieceOwner sideToMove) const;
+    uint64_t getSettingsFingerprint() const;
 
     // Utilities
     PieceOwner getOpponent(PieceOwner player) const;
@@ -37,9 +166,32 @@ private:
 
     // Members
     int m_depth;
-    int m_nodesEvaluated;
-    int m_pruneCount;
+    SearchStats m_stats;
+    GameState m_searchState; // board the search makes and unmakes moves on
+    SearchArena m_arena;     // per search scratch memory, reset at the start of each findBestMove
+    TranspositionTable m_tt;
+    std::unique_ptr<TranspositionTable> m_deterministicTt; // fresh for every deterministic search, made on first use
+    TranspositionTable* m_table; // the one the current search uses
+    uint64_t m_hashSalt;     // settings fingerprint when the table is shared, so other engines' scores never match
+    SearchLimits m_limits;
+    std::chrono::steady_clock::time_point m_searchStart;
+    bool m_aborted;          // a limit was hit, unwind without trusting any score
+    bool m_canAbort;         // false until the first iteration has finished
+
+    // Triangular PV table, row ply holds the best line from that ply down
+    Move m_pv[SearchStats::MAX_PLY][SearchStats::MAX_PLY];
+    int m_pvLength[SearchStats::MAX_PLY];
+    Move m_rootPv[SearchStats::MAX_PLY];    // line of the root search just finished
+    int m_rootPvLength;
+    std::vector<RootLine> m_lines;           // last finished iteration
+    std::vector<RootLine> m_pendingLines;    // iteration in progress, swapped in once every line is done
     PieceOwner m_player; //which player the player AI represents
+    const OpeningBook* m_openingBook;
+    bool m_verbose;
+    const EvalParams* m_params;
+    const NeuralNet* m_network;
+    SearchFeatures m_features;
+    int m_history[2][GameState::Geometry::CELLS][GameState::Geometry::CELLS]; // [player, ai][from cell][to cell] cutoff counts
 
     // Constants
     static constexpr int MIN_SCORE = std::numeric_limits<int>::min();
@@ -47,5 +199,10 @@ private:
     static constexpr int WIN_SCORE = 10000;
     static constexpr int LOSS_SCORE = -10000;
     static constexpr int NON_TERMINAL = 0;
+    static constexpr int QUIESCENCE_PLIES = 4; // hard cap on forcing moves past the nominal depth
+    static constexpr int MAX_SEARCH_DEPTH = SearchStats::MAX_PLY - 2 - QUIESCENCE_PLIES;
+    static constexpr int LMR_MIN_DEPTH = 3;  // nodes this far from the leaves or more reduce late moves
+    static constexpr int LMR_FULL_MOVES = 4; // moves searched at full depth before reductions start
+    static constexpr uint64_t SIDE_TO_MOVE_KEY = 0x9E3779B97F4A7C15ULL;
 };
 
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "NeuralNet.h"
+#include <cstdint>
+#include <vector>
+
+// One labelled movement position for network training
+struct NetSample {
+    uint8_t featureCount = 0;
+    uint8_t features[10];  // active NeuralNet inputs from the side to move's point of view
+    int heuristic = 0;     // GameState::evaluate for the side to move, sets the scale of the network's scores
+    float result = 0.5f;   // 1 win, 0.5 draw, 0 loss for the side to move
+};
+
+struct NetTrainOptions {
+    int epochs = 20;
+    int batchSize = 256;
+    float learningRate = 0.002f;
+    float validationShare = 0.1f; // held out before the symmetry copies are made
+    uint64_t seed = 1;
+};
+
+// Fits NeuralNet weights in float so that sigmoid(output) predicts the game result (mean squared error, Adam),
+// then quantizes them into the network. The training positions are used in all 8 board symmetries.
+// The heuristic's own best sigmoid scale K is fitted first and the network's output is stored as 1 / K
+// evaluation units, so its scores sit on the same scale as GameState::evaluate and the search margins.
+class NetTrainer
+{
+public:
+    NetTrainer(const NetTrainOptions& options);
+
+    bool train(const std::vector<NetSample>& samples, NeuralNet& network);
+
+private:
+    float forward(const NetSample& sample, float* hidden) const;
+    void trainBatch(const NetSample* const* batch, int count);
+    double floatLoss(const std::vector<NetSample>& samples) const;
+    static double quantizedLoss(const std::vector<NetSample>& samples, const NeuralNet& network, double k);
+    static double heuristicLoss(const std::vector<NetSample>& samples, double k);
+    static double fitHeuristicScale(const std::vector<NetSample>& samples);
+    static void addSymmetries(std::vector<NetSample>& samples);
+
+    // Weights and their Adam moments, packed in one vector: input weights, hidden biases, output weights,
+    // output bias
+    static constexpr int INPUT_WEIGHTS = 0;
+    static constexpr int HIDDEN_BIASES = INPUT_WEIGHTS + NeuralNet::INPUTS * NeuralNet::HIDDEN;
+    static constexpr int OUTPUT_WEIGHTS = HIDDEN_BIASES + NeuralNet::HIDDEN;
+    static constexpr int OUTPUT_BIAS = OUTPUT_WEIGHTS + NeuralNet::HIDDEN;
+    static constexpr int WEIGHT_COUNT = OUTPUT_BIAS + 1;
+
+    NetTrainOptions m_options;
+    std::vector<float> m_weights;
+    std::vector<float> m_gradient;
+    std::vector<float> m_momentum;
+    std::vector<float> m_velocity;
+    int m_step;
+};
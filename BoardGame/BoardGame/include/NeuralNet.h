@@ -0,0 +1,74 @@
+#pragma once
+
+#include "BoardGeometry.h"
+#include "Piece.h"
+#include <cstdint>
+#include <string>
+
+// Optional evaluation network, an alternative to the line heuristic in GameState::evaluate.
+// Inputs are one hot (own / opponent) x piece type x square, seen from each side, feeding one clipped ReLU
+// hidden layer and a single output. Inference is integer only: int16 first layer, int8 output weights.
+// The first layer sums live in an Accumulator that GameState updates as pieces move, so evaluating a leaf
+// is the hidden layer's clamp and one dot product.
+class NeuralNet
+{
+public:
+    using Geometry = StandardGeometry;
+    static constexpr int INPUTS = 2 * 3 * Geometry::CELLS;
+    static constexpr int HIDDEN = 32;
+    static constexpr int ACTIVATION_MAX = 127;     // hidden values clip to [0, 127], which is 1.0 when training
+    static constexpr int OUTPUT_WEIGHT_SCALE = 64; // output weights are stored as weight * 64 in an int8
+    static constexpr int MAX_SCORE = 9000;         // network scores stay clear of the win scores
+
+    // First layer sums from each side's point of view, [PieceOwner][hidden]
+    struct Accumulator {
+        alignas(16) int16_t values[2][HIDDEN];
+    };
+
+    NeuralNet();
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+    bool isLoaded() const { return m_loaded; }
+    // Hash of the weights, different networks give different values. Shared hash tables key on it.
+    uint64_t getFingerprint() const { return m_fingerprint; }
+
+    // Quantizes float weights from the trainer. inputWeights is [INPUTS][HIDDEN], outputScale is the
+    // evaluation units one unit of float output is worth.
+    void setWeights(const float* inputWeights, const float* hiddenBiases, const float* outputWeights, float outputBias,
+        int outputScale);
+
+    // board is Geometry::CELLS squares indexed Geometry::cell
+    void refresh(Accumulator& accumulator, Piece* const* board) const;
+    void addPiece(Accumulator& accumulator, const Piece* piece, int cell) const;
+    void removePiece(Accumulator& accumulator, const Piece* piece, int cell) const;
+    void movePiece(Accumulator& accumulator, const Piece* piece, int fromCell, int toCell) const;
+
+    // Score for player in GameState::evaluate units, within +-MAX_SCORE. Finished games aren't detected.
+    int evaluate(const Accumulator& accumulator, PieceOwner player) const;
+
+    // Score of a position given as its active inputs from the scoring side's point of view, for the trainer's
+    // checks on positions it has no GameState for
+    int evaluateFeatures(const uint8_t* features, int count) const;
+
+    static int featureIndex(PieceOwner perspective, PieceOwner owner, PieceType type, int cell);
+
+    // Network every engine picks up when it is loaded (--nnue), nullptr otherwise
+    static NeuralNet& active();
+    static const NeuralNet* getActive();
+
+    static constexpr const char* DEFAULT_PATH = "ASSETS/DATA/engine.nnue";
+
+private:
+    void addFeature(int16_t* values, int feature) const;
+    void subtractFeature(int16_t* values, int feature) const;
+    void updateFingerprint();
+
+    alignas(16) int16_t m_inputWeights[INPUTS][HIDDEN];
+    alignas(16) int16_t m_hiddenBiases[HIDDEN];
+    alignas(16) int16_t m_outputWeights[HIDDEN]; // int8 range, widened for the multiply add
+    int32_t m_outputBias;  // in ACTIVATION_MAX * OUTPUT_WEIGHT_SCALE units
+    int32_t m_outputScale;
+    uint64_t m_fingerprint;
+    bool m_loaded;
+};
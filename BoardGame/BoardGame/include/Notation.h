@@ -0,0 +1,24 @@
+#pragma once
+
+#include "GameState.h"
+#include <string>
+#include <vector>
+
+// Text names shared by the engine protocol and the analysis server.
+// Squares are a1..e5 (column letter, row number) and moves are from+to ("b2c3").
+// Boards are 25 characters, a1..e1 first and e5 last: FSD for player pieces, fsd for AI pieces, '.' empty.
+namespace Notation {
+    std::string squareName(int col, int row);
+    bool parseSquare(const std::string& text, int& col, int& row);
+    std::string moveName(const Move& move);
+
+    PieceType parsePieceType(char letter); // either case, NONE for anything else
+    char pieceLetter(const Piece* piece);  // '.' for an empty square
+
+    std::string boardString(const GameState& state);
+
+    // Places pieces taken from pool onto an empty state. Fails on a malformed string or when it
+    // needs more pieces of a kind than the pool holds.
+    bool parseBoard(const std::string& board, const std::vector<Piece*>& pool, GameState& state,
+        bool updatePiecePosition);
+}
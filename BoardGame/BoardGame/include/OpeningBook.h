@@ -0,0 +1,43 @@
+#pragma once
+
+#include "GameState.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+
+// One book position. Key is the canonical (symmetry reduced) board hash mixed with the piece being placed,
+// cell is the best square in that canonical orientation
+struct BookEntry {
+    uint64_t key;
+    int32_t score;
+    uint8_t cell;     // col * 5 + row
+    uint8_t depth;    // placement plies searched when the entry was built
+    uint16_t reserved;
+};
+
+// Placement phase opening book. Built offline with a deep placement search and memory mapped at runtime,
+// so the first placements cost a binary search instead of scoring every square.
+class OpeningBook
+{
+public:
+    OpeningBook();
+
+    bool load(const std::string& path);
+    bool isLoaded() const { return m_entries != nullptr; }
+    size_t size() const { return m_count; }
+
+    // Finds the book reply for placing this piece, false if the position isnt in the book
+    bool probe(const GameState& state, const Piece* piece, int& col, int& row) const;
+
+    // Offline builder, searches every position with less than bookPlies pieces placed
+    static bool build(const std::string& path, int bookPlies, int searchDepth);
+
+    static uint64_t makeKey(uint64_t canonicalHash, PieceType type, PieceOwner owner);
+
+    static constexpr const char* DEFAULT_PATH = "ASSETS/DATA/placement.book";
+
+private:
+    MappedFile m_file;
+    const BookEntry* m_entries;
+    size_t m_count;
+};
@@ -10,6 +10,7 @@
 // Just let compile know this exists without header reliance. 
 // * To be added
 class GameState;
+class TextureAtlas;
 
 enum class PieceType
 {
@@ -37,7 +38,10 @@ public:
     virtual bool isValidMove(const GameState& state, int fromCol, int fromRow,
         int toCol, int toRow) const = 0;
 
-    void render(sf::RenderWindow& window);
+    // Registers this piece's image with the shared atlas, call before the atlas is built
+    bool attachToAtlas(TextureAtlas& atlas);
+    // Adds this piece's quad to a batch drawn with the atlas texture
+    void appendToBatch(sf::VertexArray& batch, const TextureAtlas& atlas) const;
     void setPosition(float x, float y);
 
     // Grid position
@@ -47,21 +51,20 @@ public:
 
     PieceType getType() const { return m_type; }
     PieceOwner getOwner() const { return m_owner; }
-    sf::Vector2f getPosition() const { return m_sprite.getPosition(); }
+    sf::Vector2f getPosition() const { return m_position; }
     bool isValid() const { return m_isValid; }
 
 protected:
     PieceType m_type;
     PieceOwner m_owner;
-    sf::Texture m_texture;
-    sf::Sprite m_sprite;
+    std::string m_texturePath;
+    int m_atlasRegion;
+    sf::Vector2f m_position; //centre of the piece on screen
     bool m_isValid;
 
     //which cell this piece is currently in
     int m_gridCol;
     int m_gridRow;
-
-    void setupSprite();
 };
 
 #endif
\ No newline at end of file
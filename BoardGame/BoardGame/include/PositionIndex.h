@@ -0,0 +1,72 @@
+#pragma once
+
+#include "GameState.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A movement phase position as the square (GameState::Geometry::cell) of every piece, [player, ai].
+// The three donkeys of a side are interchangeable, so their order means nothing.
+struct MaterialSquares {
+    uint8_t frog[2];
+    uint8_t snake[2];
+    uint8_t donkeys[2][3];
+
+    // False unless each side has exactly one frog, one snake and three donkeys on the board
+    static bool fromState(const GameState& state, MaterialSquares& out);
+    // Places pool pieces on an empty state. Pool order is each side's frog, snake and three donkeys,
+    // player first, as the bench pools are built.
+    void applyTo(GameState& state, Piece* const* pool) const;
+};
+
+// Perfect ranking of movement phase positions with full material (per side a frog, a snake and three
+// donkeys) onto an integer range, with the 8 board symmetries folded out. Every position ranks to the same
+// index as all of its rotations and reflections, and unrank gives back one of them, so a solved table or
+// book can be a plain array indexed by rank instead of a hash keyed by 64 bit Zobrist values. Perfect means
+// no two positions that differ after symmetry share an index, not that every index is used: about 12% are
+// never ranked to (--rank-bench measures it).
+//
+// The index is mixed radix: (player frog, player snake) as one of the pairs left after symmetry, then the AI
+// frog and snake on the free squares, then each side's donkeys as a combination. The player frog is on the
+// smallest square of its orbit and the snake on the smallest square of its orbit under whatever symmetries
+// keep the frog still, so only positions with both of them on one axis have more than one index, the
+// others are unreachable. Side to move isn't part of the index, keep one table per side.
+class PositionIndex
+{
+public:
+    static uint64_t size();
+
+    static uint64_t rank(const MaterialSquares& squares);
+    // False when index is not below size(). An unreachable index still gives a position, one that ranks to
+    // a different index.
+    static bool unrank(uint64_t index, MaterialSquares& squares);
+
+    // False when the state doesn't hold full material
+    static bool rank(const GameState& state, uint64_t& index);
+};
+
+// Two bits per position index, for results such as unknown / win / loss / draw. All zero when built.
+class PackedResultTable
+{
+public:
+    explicit PackedResultTable(uint64_t size);
+
+    uint8_t get(uint64_t index) const
+    {
+        return (uint8_t)((m_words[index >> 5] >> ((index & 31) * 2)) & 3);
+    }
+
+    void set(uint64_t index, uint8_t value)
+    {
+        uint64_t& word = m_words[index >> 5];
+        int shift = (int)(index & 31) * 2;
+        word = (word & ~(3ull << shift)) | ((uint64_t)(value & 3) << shift);
+    }
+
+    uint64_t size() const { return m_size; }
+    size_t getMemoryBytes() const { return m_words.size() * sizeof(uint64_t); }
+
+private:
+    std::vector<uint64_t> m_words;
+    uint64_t m_size;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped timers that write a Chrome trace event file (open it in chrome://tracing or Perfetto).
+// Only built when BOARDGAME_PROFILE is defined (Debug|Win32 and the Profile configurations), otherwise the
+// macros compile to nothing.
+// Even when built in, nothing is recorded until Profiler::get().begin() is called, e.g. by --trace.
+//
+//   void Game::render()
+//   {
+//       PROFILE_FUNCTION();
+//       ...
+//   }
+
+class Profiler
+{
+public:
+    static Profiler& get();
+
+    void begin(const std::string& path);
+    void end(); // writes the trace file
+    // Read by every scope on every thread, the acquire pairs with begin so m_origin is set by then
+    bool isActive() const { return m_active.load(std::memory_order_acquire); }
+
+    void addEvent(const char* name, int64_t startMicros, int64_t durationMicros);
+    int64_t nowMicros() const;
+
+private:
+    Profiler();
+    ~Profiler();
+
+    struct TraceEvent {
+        const char* name; // string literals only, the macros pass __FUNCTION__ or a literal
+        uint32_t threadId;
+        int64_t start;
+        int64_t duration;
+    };
+
+    std::string m_path;
+    std::atomic<bool> m_active;
+    std::mutex m_mutex;
+    std::vector<TraceEvent> m_events;
+    std::chrono::steady_clock::time_point m_origin;
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name)
+        : m_name(name)
+        , m_start(Profiler::get().isActive() ? Profiler::get().nowMicros() : -1)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if (m_start >= 0) {
+            Profiler& profiler = Profiler::get();
+            profiler.addEvent(m_name, m_start, profiler.nowMicros() - m_start);
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_name;
+    int64_t m_start;
+};
+
+#ifdef BOARDGAME_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Bump pointer scratch memory for one search. Move lists, ordering scores, PV lines and undo records are
+// carved out of large blocks and given back all at once, so a warmed up search never calls the global allocator.
+// Not thread safe, each MiniMax (one per thread) owns its own.
+class SearchArena
+{
+public:
+    explicit SearchArena(size_t blockSize = 64 * 1024);
+
+    // Uninitialized storage for count objects, only for trivially destructible types since nothing is destroyed
+    template <typename T>
+    T* allocate(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destructed");
+        return static_cast<T*>(allocateBytes(sizeof(T) * count, alignof(T)));
+    }
+
+    // Stack style release: everything allocated after the mark is freed by rewind
+    struct Mark {
+        size_t block;
+        size_t offset;
+    };
+    Mark mark() const { return { m_block, m_offset }; }
+    void rewind(const Mark& mark) { m_block = mark.block; m_offset = mark.offset; }
+
+    // O(1), keeps the blocks for the next search
+    void reset() { m_block = 0; m_offset = 0; }
+
+    size_t getCapacity() const { return m_blocks.size() * m_blockSize; }
+    size_t getHighWater() const { return m_highWater; } // most bytes in use at once since construction
+
+private:
+    void* allocateBytes(size_t bytes, size_t alignment);
+
+    size_t m_blockSize;
+    std::vector<std::unique_ptr<unsigned char[]>> m_blocks;
+    size_t m_block;
+    size_t m_offset;
+    size_t m_highWater;
+};
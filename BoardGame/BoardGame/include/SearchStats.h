@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// One completed search iteration (a single fixed depth pass without iterative deepening)
+struct IterationStats {
+    int depth = 0;
+    int score = 0;
+    uint64_t nodes = 0;
+    uint64_t micros = 0;
+};
+
+// Telemetry for one findBestMove call. Counters are filled in by MiniMax as it searches,
+// the derived rates are computed on demand.
+struct SearchStats {
+    static constexpr int MAX_PLY = 32;
+
+    int depth = 0;                   // deepest iteration completed
+    int score = 0;
+    int rootMoves = 0;
+    uint64_t nodes = 0;
+    uint64_t nodesPerPly[MAX_PLY] = {}; // nodes entered at each distance from the root
+    uint64_t cutoffs = 0;            // beta cutoffs
+    uint64_t firstMoveCutoffs = 0;   // cutoffs caused by the first move searched
+    uint64_t ttProbes = 0;
+    uint64_t ttHits = 0;
+    uint64_t reductions = 0;         // late move reductions tried
+    uint64_t reSearches = 0;         // reduced moves that had to be searched again at full depth
+    uint64_t futilityPrunes = 0;     // quiet moves skipped at frontier nodes
+    uint64_t razorCuts = 0;          // two ply nodes settled by the shallow razoring search
+    uint64_t quiescenceNodes = 0;    // nodes past the nominal depth from the threat search, included in nodes
+    uint64_t forcedNodes = 0;        // nodes whose move list was narrowed to wins or defences
+    uint64_t forcedMovesSkipped = 0; // moves those nodes never searched
+    uint64_t micros = 0;
+    uint64_t allocations = 0;        // heap allocations during the search, needs BOARDGAME_COUNT_ALLOCATIONS
+    uint64_t allocatedBytes = 0;
+    std::vector<IterationStats> iterations;
+
+    void reset();
+    void add(const SearchStats& other); // totals across searches, e.g. a whole tournament
+
+    double effectiveBranchingFactor() const;
+    double firstMoveCutoffRate() const;
+    double ttHitRate() const;
+    double nodesPerSecond() const;
+    double allocationsPerNode() const;
+
+    void writeJson(std::ostream& out) const;
+    static void writeCsvHeader(std::ostream& out);
+    void writeCsvRow(std::ostream& out) const;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "GameState.h"
+#include "GameRecord.h"
+#include "MiniMax.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Settings for one side of a headless game
+struct EngineConfig {
+    std::string name = "engine";
+    int depth = 3;
+    uint64_t nodes = 0;       // node budget per move, iterative deepening up to depth within it when set
+    EvalParams params = EvalParams::active();
+    SearchFeatures features;
+    const NeuralNet* network = NeuralNet::getActive(); // nullptr searches with the line heuristic
+};
+
+// Position seen during a self-play game, kept for building training data
+struct PositionSample {
+    int8_t board[5][5];       // [col][row], 0 empty, 1 + type for player pieces, 4 + type for AI pieces
+    PieceOwner sideToMove;
+    int8_t placeCol = -1;     // square chosen when the sample is a placement decision
+    int8_t placeRow = -1;
+    PieceType placeType = PieceType::NONE;
+    bool randomChoice = false; // placement was picked at random rather than by the engine
+};
+
+struct SelfPlayOptions {
+    int randomPlacements = 2; // opening placements chosen at random so games differ
+    int maxPlies = 200;       // movement plies before the game is called a draw
+    int exploratoryPlacement = -1; // one later placement also played at random, -1 for none
+};
+
+// Plays complete games between two engines without a window.
+// Follows the same turn order as Game: player places first, pieces go down Frog, Snake, Donkeys.
+class SelfPlay
+{
+public:
+    SelfPlay();
+
+    GameResult playGame(const EngineConfig& playerConfig, const EngineConfig& aiConfig,
+        uint64_t openingSeed, const SelfPlayOptions& options);
+
+    int getLastGamePlies() const { return m_lastGamePlies; }
+
+    // Keeps every position of the last game (placements before they happen, moves after) for the tuner
+    void setRecordSamples(bool record) { m_recordSamples = record; }
+    const std::vector<PositionSample>& getLastGameSamples() const { return m_samples; }
+
+    static void fillSample(const GameState& state, PieceOwner sideToMove, PositionSample& sample);
+
+    // Every placement and move of the last game with the engine's depth, score, nodes and time per ply
+    const GameRecord& getLastGameRecord() const { return m_record; }
+
+    // Full search telemetry of every movement ply of the last game, even entries searched for the player
+    void setKeepSearchStats(bool keep) { m_keepSearchStats = keep; }
+    const std::vector<SearchStats>& getLastGameSearchStats() const { return m_searchStats; }
+
+private:
+    GameResult finish(GameResult result);
+    void recordStats(const MiniMax& engine, int depth, std::chrono::steady_clock::time_point start);
+    bool placePiece(GameState& state, MiniMax& engine, PieceOwner owner, int placed, bool randomPlacement,
+        std::mt19937_64& rng);
+
+    std::vector<std::unique_ptr<Piece>> m_pieces;
+    std::vector<Piece*> m_playerPieces;
+    std::vector<Piece*> m_aiPieces;
+    int m_lastGamePlies;
+    bool m_recordSamples;
+    std::vector<PositionSample> m_samples;
+    GameRecord m_record;
+    bool m_keepSearchStats;
+    std::vector<SearchStats> m_searchStats;
+};
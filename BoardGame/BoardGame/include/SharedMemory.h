@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read/write memory mapping that other processes on the host can map at the same time: a named shared
+// memory object, or a file, which keeps its contents between runs. A named object lives until removed or the
+// machine restarts on POSIX, but on Windows only while some process has it open. Whoever creates it gets it
+// zero filled; later openers get its existing size.
+class SharedMemory
+{
+public:
+    SharedMemory();
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    // size is only used when this call creates the mapping, created tells whether it did
+    bool openNamed(const std::string& name, size_t size, bool& created);
+    bool openFile(const std::string& path, size_t size, bool& created);
+    void close();
+
+    // Deletes a named object, processes that have it mapped keep their mapping. Always false on Windows,
+    // where there is nothing to delete once the last process has closed it.
+    static bool removeNamed(const std::string& name);
+
+#ifdef _WIN32
+    static constexpr bool NAMED_OUTLIVES_PROCESSES = false;
+#else
+    static constexpr bool NAMED_OUTLIVES_PROCESSES = true;
+#endif
+
+    unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool isOpen() const { return m_data != nullptr; }
+
+private:
+    unsigned char* m_data;
+    size_t m_size;
+
+#ifdef _WIN32
+    void* m_fileHandle;
+    void* m_mappingHandle;
+#else
+    int m_fd;
+#endif
+};
@@ -0,0 +1,47 @@
+#ifndef TEXTURE_ATLAS_HPP
+#define TEXTURE_ATLAS_HPP
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//Packs every piece image into one texture so each PNG is decoded once and all pieces draw in a single call
+class TextureAtlas
+{
+public:
+    TextureAtlas();
+
+    // Registers an image, the same path always gives the same region. Nothing is read from disk yet
+    int add(const std::string& path);
+
+    // Decodes one registered image. Different images can be loaded from different threads at once
+    size_t getImageCount() const { return m_paths.size(); }
+    const std::string& getImagePath(size_t image) const { return m_paths[image]; }
+    bool loadImage(size_t image);
+
+    // Packs every loaded image into the texture, main thread only, call once after loading.
+    // Images that failed to load get an empty region and draw nothing
+    bool build();
+    bool isBuilt() const { return m_built; }
+
+    const sf::Texture& getTexture() const { return m_texture; }
+    sf::IntRect getRegion(int region) const { return m_regions[region]; }
+
+    // Appends a textured quad (two triangles) for region, centred on center and scaled to fit inside fitSize
+    void appendQuad(sf::VertexArray& batch, int region, sf::Vector2f center, float fitSize) const;
+
+private:
+    static constexpr unsigned PADDING = 2;     // gap between images so filtering doesnt bleed
+    static constexpr unsigned MAX_WIDTH = 4096;
+
+    std::unordered_map<std::string, int> m_pathToRegion;
+    std::vector<std::string> m_paths;
+    std::vector<sf::Image> m_images; // released once built
+    std::vector<char> m_loaded;
+    std::vector<sf::IntRect> m_regions;
+    sf::Texture m_texture;
+    bool m_built;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "SelfPlay.h"
+#include <fstream>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Sequential probability ratio test: H0 = engine A is elo0 stronger, H1 = elo1 stronger
+struct SprtOptions {
+    bool enabled = false;
+    double elo0 = 0.0;
+    double elo1 = 10.0;
+    double alpha = 0.05; // false positive rate
+    double beta = 0.05;  // false negative rate
+
+    double lowerBound() const;
+    double upperBound() const;
+};
+
+enum class SprtResult {
+    INCONCLUSIVE,
+    H0_ACCEPTED, // change is not an improvement
+    H1_ACCEPTED  // change is an improvement
+};
+
+struct TournamentOptions {
+    EngineConfig engineA;
+    EngineConfig engineB;
+    int games = 1000;
+    int threads = 0;   // 0 = one worker per core
+    uint64_t seed = 1;
+    SelfPlayOptions play;
+    SprtOptions sprt;     // stops early once the test is decided, games is then the cap
+    std::string recordPath; // every game is appended here when set
+    std::string searchStatsPath; // CSV of every movement search when set
+};
+
+// Win/draw/loss totals from engine A's point of view
+struct TournamentStats {
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+
+    int games() const { return wins + draws + losses; }
+    double score() const;
+    double elo() const;
+    double eloError() const; // 95% confidence half width
+    double llr(double elo0, double elo1) const; // SPRT log likelihood ratio
+};
+
+// Runs many headless games between two engines across all cores, one game per worker at a time.
+// Games come in pairs that share a random opening with colours swapped.
+class Tournament
+{
+public:
+    Tournament(const TournamentOptions& options);
+
+    TournamentStats run();
+    SprtResult getSprtResult() const { return m_sprtResult; }
+
+    static double scoreToElo(double score);
+    static double eloToScore(double elo);
+    static void printStats(const TournamentStats& stats, double seconds);
+
+private:
+    void worker();
+    void checkSprt(); // call with the stats mutex held
+    void writeSearchStats(int game, bool aIsPlayer, const std::vector<SearchStats>& searches); // same
+
+    TournamentOptions m_options;
+    TournamentStats m_stats;
+    std::mutex m_statsMutex;
+    std::atomic<int> m_nextGame;
+    std::atomic<bool> m_stop;
+    SprtResult m_sprtResult;
+    GameRecordWriter m_recordWriter;
+    std::ofstream m_searchStatsFile;
+    SearchStats m_searchTotals[2]; // engine A, engine B
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "SharedMemory.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Bound type of a stored score, relative to the alpha-beta window it was searched with
+enum class TTBound : uint8_t {
+    NONE,
+    EXACT,
+    LOWER, // failed high, real score is at least this
+    UPPER  // failed low, real score is at most this
+};
+
+// What probe finds. Cells are GameState::Geometry::cell, 255 when there is no move.
+struct TTEntry {
+    uint64_t key;
+    int32_t score;
+    int8_t depth;
+    TTBound bound;
+    uint8_t fromCell;
+    uint8_t toCell;
+};
+
+// Where every engine created afterwards keeps its table. With neither a name nor a path each engine has its
+// own in process memory, otherwise all engines in all processes opening the same one search into one table.
+struct TTBackend {
+    std::string sharedName; // named shared memory (--shared-hash), see SharedMemory for how long it lives
+    std::string filePath;   // memory mapped file (--hash-file), kept between runs to warm start the next one
+    size_t entryCountLog2 = 20; // size used by whichever process creates it, 16 MB
+
+    bool isShared() const { return !sharedName.empty() || !filePath.empty(); }
+
+    static TTBackend& active();
+};
+
+// Fixed size hash of searched positions. Slots are two 64 bit words, the packed entry and the key xor'ed with
+// it, written and read without locks. Writers racing on a slot can leave one word from each, the xor then
+// matches no key and the slot reads as a miss, so any number of threads or processes can share a table.
+// Scores are from the side to move's point of view. MiniMax salts the keys of a shared table with its side and
+// settings, since its evaluation differs between the sides, so only engines that would agree share entries.
+//
+// A shared table lives after a small header in a SharedMemory mapping, in the same layout save writes, so a
+// saved table can be mapped back with openFile as well as reloaded with load.
+class TranspositionTable
+{
+public:
+    static constexpr uint8_t NO_CELL = 255;
+
+    explicit TranspositionTable(size_t entryCountLog2 = 16);
+    ~TranspositionTable();
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Maps the backend's table, creating it at the backend's size if nobody has yet. An existing table keeps
+    // its size and contents. False leaves this table as it was.
+    bool open(const TTBackend& backend);
+    bool isShared() const { return m_shared != nullptr; }
+    bool isNew() const { return m_created; } // open created the table rather than finding one
+
+    // Empties the table, for every process when it is shared
+    void clear();
+
+    bool probe(uint64_t key, TTEntry& entry) const;
+    // Keeps the deeper result when the slot already holds the same position
+    void store(uint64_t key, int score, int depth, TTBound bound, uint8_t fromCell, uint8_t toCell);
+
+    // Snapshot of every filled slot, and merging one back in at any table size
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    size_t getSize() const { return (size_t)m_mask + 1; }
+    int getPermilleFull() const; // sampled from the first 1000 slots
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> check; // key ^ data
+        std::atomic<uint64_t> data;
+    };
+    static_assert(sizeof(Slot) == 16, "four slots to a cache line");
+
+    // In front of the slots of a mapped or saved table
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCountLog2;
+        std::atomic<uint32_t> ready; // set by the creator once the rest is written
+        uint8_t reserved[48];
+    };
+    static_assert(sizeof(Header) == 64, "keeps the slots cache line aligned");
+
+    static uint64_t pack(int score, int depth, TTBound bound, uint8_t fromCell, uint8_t toCell);
+    static bool attach(SharedMemory& memory, bool created, size_t entryCountLog2);
+
+    std::unique_ptr<Slot[]> m_ownSlots;     // in process table, null when shared
+    std::unique_ptr<SharedMemory> m_shared; // mapping the slots are in, null when not shared
+    Slot* m_slots;
+    uint64_t m_mask;
+    bool m_created = false;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "SelfPlay.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct TunerOptions {
+    int games = 2000;        // self-play games used to generate positions
+    int depth = 2;
+    int threads = 0;         // 0 = one per core
+    int randomPlacements = 4;
+    uint64_t seed = 1;
+    int maxIterations = 200; // local search passes over every weight
+    int epochs = 20;         // network training passes (runNetwork)
+    std::string dataPath;    // labelled positions, reused when the file already exists
+    std::string outPath = EvalParams::DEFAULT_PATH;
+};
+
+// Texel style weight tuning: labels self-play positions with the game result and fits the
+// evaluation weights so that sigmoid(K * eval) predicts that result, by local search on the mean squared error.
+class Tuner
+{
+public:
+    Tuner(const TunerOptions& options);
+    ~Tuner();
+
+    bool run();
+    // Trains the evaluation network on the same positions instead and writes it to outPath
+    bool runNetwork();
+
+private:
+    struct LabelledSample {
+        PositionSample position;
+        float result; // 1 win, 0.5 draw, 0 loss for the side to move
+    };
+
+    // Features for a linear model, stored column by column so the loss loops vectorize
+    struct FeatureSet {
+        int columns = 0;
+        size_t count = 0;
+        std::vector<float> values;  // values[column * count + i]
+        std::vector<float> results;
+    };
+
+    // Threads kept for a whole tuning run, every computeLoss call hands them one slice of the samples each
+    class WorkerPool;
+
+    // Turns the weights being tuned into one coefficient per feature column
+    using CoefficientFn = void (*)(const std::vector<int>& weights, std::vector<float>& coefficients);
+
+    bool prepareSamples();
+    void generatePositions();
+    bool loadPositions(const std::string& path);
+    bool savePositions(const std::string& path) const;
+
+    void buildEvalFeatures(FeatureSet& set) const;
+    void buildPlacementFeatures(FeatureSet& set, const EvalParams& params) const;
+    void buildState(const PositionSample& sample, GameState& state) const;
+    void addPlacementFeatures(FeatureSet& set, size_t index, const MiniMax& engine, const GameState& state,
+        int col, int row, Piece* piece, float weight) const;
+
+    double computeLoss(const FeatureSet& set, const std::vector<float>& coefficients, double k) const;
+    double fitScale(const FeatureSet& set, const std::vector<float>& coefficients) const;
+    double localSearch(const FeatureSet& set, std::vector<int>& weights, CoefficientFn toCoefficients, double k) const;
+
+    static void evalCoefficients(const std::vector<int>& weights, std::vector<float>& coefficients);
+    static void placementCoefficients(const std::vector<int>& weights, std::vector<float>& coefficients);
+    static int symmetryClass(int col, int row);
+
+    TunerOptions m_options;
+    int m_threads;
+    std::unique_ptr<WorkerPool> m_workers; // made by run, computeLoss is called thousands of times per run
+    std::vector<LabelledSample> m_samples;
+    std::vector<std::unique_ptr<Piece>> m_pieces; // headless pool used to rebuild sample positions
+};
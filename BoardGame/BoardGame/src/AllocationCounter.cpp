@@ -0,0 +1,73 @@
+#include "AllocationCounter.h"
+
+#ifdef BOARDGAME_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // Plain integers so counting never allocates itself
+    thread_local uint64_t t_allocations = 0;
+    thread_local uint64_t t_bytes = 0;
+
+    void* countedAllocate(std::size_t size)
+    {
+        t_allocations++;
+        t_bytes += size;
+        return std::malloc(size ? size : 1);
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    void* p = countedAllocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* p = countedAllocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+bool AllocationCounter::isEnabled()
+{
+    return true;
+}
+
+AllocationCounter::Snapshot AllocationCounter::current()
+{
+    return { t_allocations, t_bytes };
+}
+
+#else
+
+bool AllocationCounter::isEnabled()
+{
+    return false;
+}
+
+AllocationCounter::Snapshot AllocationCounter::current()
+{
+    return {};
+}
+
+#endif
@@ -0,0 +1,357 @@
+#include "AnalysisServer.h"
+#include "Frog.h"
+#include "Snake.h"
+#include "Donkey.h"
+#include "Notation.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+AnalysisServer::AnalysisServer(const AnalysisServerOptions& options)
+    : m_options(options)
+    , m_nextSequence(0)
+    , m_running(false)
+    , m_stopSearches(false)
+{
+    // Queued positions only point at these, searches never move them
+    for (PieceOwner owner : { PieceOwner::PLAYER, PieceOwner::AI }) {
+        m_pieces.push_back(std::make_unique<Frog>(owner, ""));
+        m_pieces.push_back(std::make_unique<Snake>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+    }
+    for (auto& piece : m_pieces) m_piecePool.push_back(piece.get());
+}
+
+AnalysisServer::~AnalysisServer()
+{
+    m_stopSearches = true;
+    m_running = false;
+    m_queueReady.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+bool AnalysisServer::run()
+{
+    sf::TcpListener listener;
+    if (listener.listen(m_options.port, sf::IpAddress::LocalHost) != sf::Socket::Status::Done) {
+        std::cout << "Analysis server: could not listen on port " << m_options.port << std::endl;
+        return false;
+    }
+
+    int threads = m_options.threads > 0 ? m_options.threads : (int)std::thread::hardware_concurrency();
+    threads = std::max(1, threads);
+
+    m_running = true;
+    for (int i = 0; i < threads; i++) {
+        auto worker = std::make_unique<Worker>();
+        worker->playerEngine = std::make_unique<MiniMax>(PieceOwner::PLAYER);
+        worker->aiEngine = std::make_unique<MiniMax>(PieceOwner::AI);
+        worker->playerEngine->setVerbose(false);
+        worker->aiEngine->setVerbose(false);
+        m_workers.push_back(std::move(worker));
+    }
+    for (auto& worker : m_workers) {
+        Worker* w = worker.get();
+        w->thread = std::thread([this, w]() { workerLoop(*w); });
+    }
+
+    std::cout << "Analysis server: listening on 127.0.0.1:" << m_options.port << " with " << threads
+        << " workers" << std::endl;
+
+    sf::SocketSelector selector;
+    selector.add(listener);
+    bool serving = true;
+
+    while (serving) {
+        // Short timeout so finished results go out without waiting for more input
+        if (selector.wait(sf::milliseconds(2))) {
+            if (selector.isReady(listener)) {
+                auto client = std::make_unique<Client>();
+                if (listener.accept(client->socket) == sf::Socket::Status::Done) {
+                    selector.add(client->socket);
+                    m_clients.push_back(std::move(client));
+                }
+            }
+
+            for (auto& client : m_clients) {
+                if (client->closed || !selector.isReady(client->socket)) continue;
+
+                char data[4096];
+                std::size_t received = 0;
+                if (client->socket.receive(data, sizeof(data), received) != sf::Socket::Status::Done) {
+                    client->closed = true;
+                    continue;
+                }
+
+                client->buffer.append(data, received);
+                std::size_t end;
+                while (serving && !client->closed && (end = client->buffer.find('\n')) != std::string::npos) {
+                    std::string line = client->buffer.substr(0, end);
+                    client->buffer.erase(0, end + 1);
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    serving = handleLine(*client, line);
+                }
+            }
+        }
+
+        for (auto& client : m_clients) {
+            if (!client->closed) sendFinished(*client);
+        }
+
+        for (auto it = m_clients.begin(); it != m_clients.end();) {
+            if ((*it)->closed) {
+                dropPending(**it);
+                selector.remove((*it)->socket);
+                it = m_clients.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    m_stopSearches = true;
+    m_running = false;
+    m_queueReady.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+
+    std::cout << "Analysis server: " << formatMetrics() << std::endl;
+    return true;
+}
+
+bool AnalysisServer::handleLine(Client& client, const std::string& line)
+{
+    std::istringstream tokens(line);
+    std::string command;
+    if (!(tokens >> command)) return true;
+
+    if (command == "analyze") {
+        queueRequest(client, tokens);
+    }
+    else if (command == "metrics") {
+        std::string reply = formatMetrics() + "\n";
+        if (client.socket.send(reply.data(), reply.size()) != sf::Socket::Status::Done) client.closed = true;
+    }
+    else if (command == "quit") {
+        client.closed = true;
+    }
+    else if (command == "shutdown") {
+        return false;
+    }
+    else {
+        std::string reply = "error - unknown command " + command + "\n";
+        if (client.socket.send(reply.data(), reply.size()) != sf::Socket::Status::Done) client.closed = true;
+    }
+    return true;
+}
+
+void AnalysisServer::queueRequest(Client& client, std::istringstream& tokens)
+{
+    Request request;
+    request.sequence = m_nextSequence++;
+    request.arrival = std::chrono::steady_clock::now();
+    request.side = PieceOwner::PLAYER;
+    client.pending.push_back(request.sequence);
+
+    {
+        std::lock_guard<std::mutex> lock(m_metricsMutex);
+        m_metrics.received++;
+    }
+
+    // Bad requests still take their place in the reply order
+    std::string board;
+    if (!(tokens >> request.id >> board)) {
+        reject(request.sequence, "error - expected analyze <id> <board>");
+        return;
+    }
+    if (std::count(board.begin(), board.end(), '.') != 15
+        || !Notation::parseBoard(board, m_piecePool, request.state, false)) {
+        reject(request.sequence, "error " + request.id + " expected a board with all ten pieces");
+        return;
+    }
+    request.state.setPhase(GamePhase::MOVEMENT);
+
+    std::string word;
+    while (tokens >> word) {
+        if (word == "turn") {
+            std::string side;
+            tokens >> side;
+            request.side = side == "ai" ? PieceOwner::AI : PieceOwner::PLAYER;
+        }
+        else if (word == "depth") tokens >> request.limits.depth;
+        else if (word == "movetime") tokens >> request.limits.timeMs;
+        else if (word == "nodes") tokens >> request.limits.nodes;
+        else if (word == "deterministic") request.limits.deterministic = true;
+    }
+    // A deterministic search ignores movetime, so it needs a depth or node budget too
+    if (request.limits.depth <= 0 && request.limits.nodes == 0
+        && (request.limits.timeMs <= 0 || request.limits.deterministic)) {
+        request.limits.depth = m_options.defaultDepth;
+    }
+    request.limits.stop = &m_stopSearches;
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.push_back(std::move(request));
+
+        std::lock_guard<std::mutex> metricsLock(m_metricsMutex);
+        m_metrics.queueDepth = (int)m_queue.size();
+        m_metrics.peakQueueDepth = std::max(m_metrics.peakQueueDepth, m_metrics.queueDepth);
+    }
+    m_queueReady.notify_one();
+}
+
+void AnalysisServer::reject(uint64_t sequence, const std::string& line)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_metricsMutex);
+        m_metrics.rejected++;
+    }
+    finish(sequence, line);
+}
+
+void AnalysisServer::finish(uint64_t sequence, const std::string& line)
+{
+    std::lock_guard<std::mutex> lock(m_finishedMutex);
+    if (m_abandoned.erase(sequence) > 0) return;
+    m_finished[sequence] = line;
+}
+
+// A closed connection's requests are taken off the queue unsearched, results already in are discarded and
+// the ones still being searched are discarded by finish
+void AnalysisServer::dropPending(const Client& client)
+{
+    if (client.pending.empty()) return;
+    std::unordered_set<uint64_t> sequences(client.pending.begin(), client.pending.end());
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        for (auto it = m_queue.begin(); it != m_queue.end();) {
+            if (sequences.erase(it->sequence) > 0) it = m_queue.erase(it);
+            else ++it;
+        }
+
+        std::lock_guard<std::mutex> metricsLock(m_metricsMutex);
+        m_metrics.queueDepth = (int)m_queue.size();
+    }
+
+    // Anything neither queued nor finished by now is on a worker
+    std::lock_guard<std::mutex> lock(m_finishedMutex);
+    for (uint64_t sequence : sequences) {
+        if (m_finished.erase(sequence) == 0) m_abandoned.insert(sequence);
+    }
+}
+
+// Sends finished results up to the first one still being searched
+void AnalysisServer::sendFinished(Client& client)
+{
+    std::string reply;
+    {
+        std::lock_guard<std::mutex> lock(m_finishedMutex);
+        while (!client.pending.empty()) {
+            auto it = m_finished.find(client.pending.front());
+            if (it == m_finished.end()) break;
+
+            reply += it->second;
+            reply += '\n';
+            m_finished.erase(it);
+            client.pending.pop_front();
+        }
+    }
+
+    if (!reply.empty() && client.socket.send(reply.data(), reply.size()) != sf::Socket::Status::Done) {
+        client.closed = true;
+    }
+}
+
+void AnalysisServer::workerLoop(Worker& worker)
+{
+    while (true) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueReady.wait(lock, [this]() { return !m_running || !m_queue.empty(); });
+            if (!m_running) return;
+
+            request = std::move(m_queue.front());
+            m_queue.pop_front();
+
+            std::lock_guard<std::mutex> metricsLock(m_metricsMutex);
+            m_metrics.queueDepth = (int)m_queue.size();
+            m_metrics.busyWorkers++;
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        double waitMs = std::chrono::duration<double, std::milli>(started - request.arrival).count();
+        std::string line = analyze(worker, request, waitMs);
+        double latencyMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - request.arrival).count();
+
+        {
+            std::lock_guard<std::mutex> lock(m_metricsMutex);
+            m_metrics.busyWorkers--;
+            m_metrics.completed++;
+            m_metrics.totalWaitMs += waitMs;
+            m_metrics.maxWaitMs = std::max(m_metrics.maxWaitMs, waitMs);
+            m_metrics.totalLatencyMs += latencyMs;
+            m_metrics.maxLatencyMs = std::max(m_metrics.maxLatencyMs, latencyMs);
+        }
+
+        finish(request.sequence, line);
+    }
+}
+
+std::string AnalysisServer::analyze(Worker& worker, const Request& request, double waitMs)
+{
+    MiniMax& engine = request.side == PieceOwner::PLAYER ? *worker.playerEngine : *worker.aiEngine;
+
+    std::ostringstream line;
+    line << "result " << request.id << " bestmove ";
+    if (request.state.getWinner() != PieceOwner::NONE) {
+        line << "none score 0 depth 0 nodes 0 wait " << (int)waitMs << " time 0 pv";
+        return line.str();
+    }
+
+    Move best = engine.search(request.state, request.limits);
+    const SearchStats& stats = engine.getSearchStats();
+    {
+        std::lock_guard<std::mutex> lock(m_metricsMutex);
+        m_metrics.nodes += stats.nodes;
+    }
+
+    line << (best.piece ? Notation::moveName(best) : "none") << " score " << stats.score << " depth " << stats.depth
+        << " nodes " << stats.nodes << " wait " << (int)waitMs << " time " << stats.micros / 1000 << " pv";
+    for (const Move& move : engine.getPrincipalVariation()) {
+        line << ' ' << Notation::moveName(move);
+    }
+    return line.str();
+}
+
+AnalysisMetrics AnalysisServer::getMetrics() const
+{
+    std::lock_guard<std::mutex> lock(m_metricsMutex);
+    return m_metrics;
+}
+
+std::string AnalysisServer::formatMetrics() const
+{
+    AnalysisMetrics metrics = getMetrics();
+    double completed = metrics.completed > 0 ? (double)metrics.completed : 1.0;
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1)
+        << "metrics queued " << metrics.queueDepth << " peak " << metrics.peakQueueDepth
+        << " busy " << metrics.busyWorkers << "/" << m_workers.size()
+        << " received " << metrics.received << " completed " << metrics.completed
+        << " rejected " << metrics.rejected << " nodes " << metrics.nodes
+        << " wait_avg " << metrics.totalWaitMs / completed << " wait_max " << metrics.maxWaitMs
+        << " latency_avg " << metrics.totalLatencyMs / completed << " latency_max " << metrics.maxLatencyMs;
+    return line.str();
+}
@@ -0,0 +1,50 @@
+#include "AssetLoader.h"
+#include <algorithm>
+#include <iostream>
+
+AssetLoader::AssetLoader()
+    : m_nextJob(0)
+    , m_completed(0)
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+    wait();
+}
+
+void AssetLoader::addJob(const std::string& name, std::function<bool()> job)
+{
+    m_jobs.push_back({ name, std::move(job) });
+}
+
+void AssetLoader::start(int threads)
+{
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    threads = std::max(1, std::min(threads, (int)m_jobs.size()));
+
+    for (int i = 0; i < threads; i++) {
+        m_threads.emplace_back(&AssetLoader::worker, this);
+    }
+}
+
+void AssetLoader::wait()
+{
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) thread.join();
+    }
+    m_threads.clear();
+}
+
+void AssetLoader::worker()
+{
+    while (true) {
+        int index = m_nextJob++;
+        if (index >= (int)m_jobs.size()) break;
+
+        if (!m_jobs[index].run()) {
+            std::cout << "Error loading " << m_jobs[index].name << std::endl;
+        }
+        m_completed++;
+    }
+}
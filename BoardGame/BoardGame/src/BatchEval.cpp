@@ -0,0 +1,313 @@
+#include "BatchEval.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BATCH_EVAL_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define BATCH_EVAL_AVX2
+#else
+#define BATCH_EVAL_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+PackedPosition PackedPosition::fromState(const GameState& state)
+{
+    PackedPosition packed;
+    for (int col = 0; col < 5; col++) {
+        for (int row = 0; row < 5; row++) {
+            Piece* piece = state.getPieceAt(col, row);
+            if (!piece) continue;
+            (piece->getOwner() == PieceOwner::PLAYER ? packed.player : packed.ai) |= 1u << (col * 5 + row);
+        }
+    }
+    return packed;
+}
+
+PackedPosition PackedPosition::fromSample(const PositionSample& sample)
+{
+    // Sample codes: 0 empty, 1 + type for player pieces, 4 + type for AI pieces
+    PackedPosition packed;
+    for (int col = 0; col < 5; col++) {
+        for (int row = 0; row < 5; row++) {
+            int code = sample.board[col][row];
+            if (code == 0) continue;
+            (code < 4 ? packed.player : packed.ai) |= 1u << (col * 5 + row);
+        }
+    }
+    return packed;
+}
+
+BatchEvaluator::BatchEvaluator(const EvalParams& params)
+{
+    for (int line = 0; line < GameState::LINE_COUNT; line++) {
+        m_lineMasks[line] = GameState::getLineMask(line);
+        for (int cell = 0, found = 0; cell < 25; cell++) {
+            if (m_lineMasks[line] & (1u << cell)) m_lineCells[line][found++] = (uint8_t)cell;
+        }
+    }
+
+    // evaluate(side) = offense * lines(side) - defense * lines(other) + center * (centre(side) - centre(other))
+    const int lineScores[8] = { 0, params.lineOne, params.lineTwo, params.lineThree, 0, 0, 0, 0 };
+    for (PieceOwner side : { PieceOwner::PLAYER, PieceOwner::AI }) {
+        Tables& tables = side == PieceOwner::PLAYER ? m_playerTables : m_aiTables;
+        int playerSign = side == PieceOwner::PLAYER ? 1 : -1;
+        int playerLineWeight = side == PieceOwner::PLAYER ? params.offenseWeight : -params.defenseWeight;
+        int aiLineWeight = side == PieceOwner::AI ? params.offenseWeight : -params.defenseWeight;
+
+        for (int count = 0; count < 8; count++) {
+            tables.playerLine[count] = lineScores[count] * playerLineWeight;
+            tables.aiLine[count] = lineScores[count] * aiLineWeight;
+        }
+        for (int col = 0; col < 5; col++) {
+            for (int row = 0; row < 5; row++) {
+                int value = params.centerValues[row][col] * params.centerWeight;
+                tables.playerSquare[col * 5 + row] = value * playerSign;
+                tables.aiSquare[col * 5 + row] = -value * playerSign;
+            }
+        }
+        tables.playerWin = 10000 * playerSign;
+        tables.aiWin = -10000 * playerSign;
+    }
+}
+
+const BatchEvaluator::Tables& BatchEvaluator::getTables(PieceOwner player) const
+{
+    return player == PieceOwner::PLAYER ? m_playerTables : m_aiTables;
+}
+
+void BatchEvaluator::evaluate(const PackedPosition* positions, size_t count, PieceOwner player, int* scores) const
+{
+    evaluate(positions, count, player, scores, getBestKernel());
+}
+
+void BatchEvaluator::evaluate(const PackedPosition* positions, size_t count, PieceOwner player, int* scores,
+    BatchKernel kernel) const
+{
+    const Tables& tables = getTables(player);
+    if (!isSupported(kernel)) kernel = getBestKernel();
+
+    switch (kernel) {
+    case BatchKernel::AVX2: evaluateAvx2(positions, count, tables, scores); break;
+    case BatchKernel::SSE2: evaluateSse2(positions, count, tables, scores); break;
+    default: evaluateScalar(positions, count, tables, scores); break;
+    }
+}
+
+BatchKernel BatchEvaluator::getBestKernel()
+{
+    static const BatchKernel best = isSupported(BatchKernel::AVX2) ? BatchKernel::AVX2
+        : (isSupported(BatchKernel::SSE2) ? BatchKernel::SSE2 : BatchKernel::SCALAR);
+    return best;
+}
+
+bool BatchEvaluator::isSupported(BatchKernel kernel)
+{
+    switch (kernel) {
+    case BatchKernel::SCALAR:
+        return true;
+#ifdef BATCH_EVAL_X86
+    case BatchKernel::SSE2:
+        return true; // every x86 target the project builds for has it
+    case BatchKernel::AVX2: {
+#ifdef _MSC_VER
+        // AVX2 in the CPU and the OS saving the wide registers on a context switch
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5));
+#else
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+const char* BatchEvaluator::getKernelName(BatchKernel kernel)
+{
+    switch (kernel) {
+    case BatchKernel::SSE2: return "sse2";
+    case BatchKernel::AVX2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+static int countBits(uint32_t bits)
+{
+    bits = bits - ((bits >> 1) & 0x55555555u);
+    bits = (bits & 0x33333333u) + ((bits >> 2) & 0x33333333u);
+    return (int)((((bits + (bits >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24);
+}
+
+void BatchEvaluator::evaluateScalar(const PackedPosition* positions, size_t count, const Tables& tables,
+    int* scores) const
+{
+    for (size_t i = 0; i < count; i++) {
+        uint32_t player = positions[i].player;
+        uint32_t ai = positions[i].ai;
+        bool playerWins = false, aiWins = false;
+        int score = 0;
+
+        for (uint32_t mask : m_lineMasks) {
+            int playerCount = countBits(player & mask);
+            int aiCount = countBits(ai & mask);
+            playerWins |= playerCount == 4;
+            aiWins |= aiCount == 4;
+            // Masked rather than branched on, which side a line belongs to is close to random
+            score += tables.playerLine[playerCount] & -(int)(aiCount == 0);
+            score += tables.aiLine[aiCount] & -(int)(playerCount == 0);
+        }
+        for (int cell = 0; cell < 25; cell++) {
+            score += tables.playerSquare[cell] & -(int)((player >> cell) & 1);
+            score += tables.aiSquare[cell] & -(int)((ai >> cell) & 1);
+        }
+
+        scores[i] = playerWins ? tables.playerWin : (aiWins ? tables.aiWin : score);
+    }
+}
+
+#ifdef BATCH_EVAL_X86
+
+// Both kernels first turn each square into a lane mask (all ones where the square is taken), so a line's
+// piece count is minus the sum of its four square masks and a centre term is the square value masked in.
+
+void BatchEvaluator::evaluateSse2(const PackedPosition* positions, size_t count, const Tables& tables,
+    int* scores) const
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2), three = _mm_set1_epi32(3);
+    const __m128i four = _mm_set1_epi32(4);
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        // 4 interleaved (player, ai) pairs split into a register of each
+        __m128 first = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(positions + i)));
+        __m128 second = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(positions + i + 2)));
+        __m128i player = _mm_castps_si128(_mm_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i ai = _mm_castps_si128(_mm_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        __m128i playerSquares[25], aiSquares[25];
+        __m128i score = zero;
+        for (int cell = 0; cell < 25; cell++) {
+            __m128i bit = _mm_set1_epi32(1 << cell);
+            playerSquares[cell] = _mm_cmpeq_epi32(_mm_and_si128(player, bit), bit);
+            aiSquares[cell] = _mm_cmpeq_epi32(_mm_and_si128(ai, bit), bit);
+            score = _mm_add_epi32(score, _mm_and_si128(playerSquares[cell], _mm_set1_epi32(tables.playerSquare[cell])));
+            score = _mm_add_epi32(score, _mm_and_si128(aiSquares[cell], _mm_set1_epi32(tables.aiSquare[cell])));
+        }
+
+        __m128i playerWins = zero, aiWins = zero;
+        for (int line = 0; line < GameState::LINE_COUNT; line++) {
+            __m128i lineMask = _mm_set1_epi32((int)m_lineMasks[line]);
+            __m128i playerCount = zero, aiCount = zero;
+            for (int cell : m_lineCells[line]) {
+                playerCount = _mm_sub_epi32(playerCount, playerSquares[cell]);
+                aiCount = _mm_sub_epi32(aiCount, aiSquares[cell]);
+            }
+            __m128i playerOpen = _mm_cmpeq_epi32(_mm_and_si128(ai, lineMask), zero);
+            __m128i aiOpen = _mm_cmpeq_epi32(_mm_and_si128(player, lineMask), zero);
+
+            // No byte shuffle across 32 bit lanes before SSSE3, so the count picks its score by compares
+            __m128i playerLine = _mm_or_si128(_mm_or_si128(
+                _mm_and_si128(_mm_cmpeq_epi32(playerCount, one), _mm_set1_epi32(tables.playerLine[1])),
+                _mm_and_si128(_mm_cmpeq_epi32(playerCount, two), _mm_set1_epi32(tables.playerLine[2]))),
+                _mm_and_si128(_mm_cmpeq_epi32(playerCount, three), _mm_set1_epi32(tables.playerLine[3])));
+            __m128i aiLine = _mm_or_si128(_mm_or_si128(
+                _mm_and_si128(_mm_cmpeq_epi32(aiCount, one), _mm_set1_epi32(tables.aiLine[1])),
+                _mm_and_si128(_mm_cmpeq_epi32(aiCount, two), _mm_set1_epi32(tables.aiLine[2]))),
+                _mm_and_si128(_mm_cmpeq_epi32(aiCount, three), _mm_set1_epi32(tables.aiLine[3])));
+            score = _mm_add_epi32(score, _mm_and_si128(playerLine, playerOpen));
+            score = _mm_add_epi32(score, _mm_and_si128(aiLine, aiOpen));
+
+            playerWins = _mm_or_si128(playerWins, _mm_cmpeq_epi32(playerCount, four));
+            aiWins = _mm_or_si128(aiWins, _mm_cmpeq_epi32(aiCount, four));
+        }
+
+        __m128i result = _mm_or_si128(_mm_and_si128(aiWins, _mm_set1_epi32(tables.aiWin)), _mm_andnot_si128(aiWins, score));
+        result = _mm_or_si128(_mm_and_si128(playerWins, _mm_set1_epi32(tables.playerWin)),
+            _mm_andnot_si128(playerWins, result));
+        _mm_storeu_si128((__m128i*)(scores + i), result);
+    }
+
+    evaluateScalar(positions + i, count - i, tables, scores + i);
+}
+
+BATCH_EVAL_AVX2
+void BatchEvaluator::evaluateAvx2(const PackedPosition* positions, size_t count, const Tables& tables,
+    int* scores) const
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i four = _mm256_set1_epi32(4);
+    const __m256i playerLineTable = _mm256_loadu_si256((const __m256i*)tables.playerLine);
+    const __m256i aiLineTable = _mm256_loadu_si256((const __m256i*)tables.aiLine);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        // The in lane float shuffle leaves positions 0 1 4 5 2 3 6 7, so the 64 bit halves are put back in order
+        __m256 first = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(positions + i)));
+        __m256 second = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(positions + i + 4)));
+        __m256i player = _mm256_permute4x64_epi64(
+            _mm256_castps_si256(_mm256_shuffle_ps(first, second, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i ai = _mm256_permute4x64_epi64(
+            _mm256_castps_si256(_mm256_shuffle_ps(first, second, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+
+        __m256i playerSquares[25], aiSquares[25];
+        __m256i score = zero;
+        for (int cell = 0; cell < 25; cell++) {
+            __m256i bit = _mm256_set1_epi32(1 << cell);
+            playerSquares[cell] = _mm256_cmpeq_epi32(_mm256_and_si256(player, bit), bit);
+            aiSquares[cell] = _mm256_cmpeq_epi32(_mm256_and_si256(ai, bit), bit);
+            score = _mm256_add_epi32(score,
+                _mm256_and_si256(playerSquares[cell], _mm256_set1_epi32(tables.playerSquare[cell])));
+            score = _mm256_add_epi32(score, _mm256_and_si256(aiSquares[cell], _mm256_set1_epi32(tables.aiSquare[cell])));
+        }
+
+        __m256i playerWins = zero, aiWins = zero;
+        for (int line = 0; line < GameState::LINE_COUNT; line++) {
+            __m256i lineMask = _mm256_set1_epi32((int)m_lineMasks[line]);
+            __m256i playerCount = zero, aiCount = zero;
+            for (int cell : m_lineCells[line]) {
+                playerCount = _mm256_sub_epi32(playerCount, playerSquares[cell]);
+                aiCount = _mm256_sub_epi32(aiCount, aiSquares[cell]);
+            }
+            __m256i playerOpen = _mm256_cmpeq_epi32(_mm256_and_si256(ai, lineMask), zero);
+            __m256i aiOpen = _mm256_cmpeq_epi32(_mm256_and_si256(player, lineMask), zero);
+
+            // The count indexes the 8 entry score table directly
+            score = _mm256_add_epi32(score,
+                _mm256_and_si256(_mm256_permutevar8x32_epi32(playerLineTable, playerCount), playerOpen));
+            score = _mm256_add_epi32(score, _mm256_and_si256(_mm256_permutevar8x32_epi32(aiLineTable, aiCount), aiOpen));
+
+            playerWins = _mm256_or_si256(playerWins, _mm256_cmpeq_epi32(playerCount, four));
+            aiWins = _mm256_or_si256(aiWins, _mm256_cmpeq_epi32(aiCount, four));
+        }
+
+        __m256i result = _mm256_blendv_epi8(score, _mm256_set1_epi32(tables.aiWin), aiWins);
+        result = _mm256_blendv_epi8(result, _mm256_set1_epi32(tables.playerWin), playerWins);
+        _mm256_storeu_si256((__m256i*)(scores + i), result);
+    }
+
+    evaluateScalar(positions + i, count - i, tables, scores + i);
+}
+
+#else
+
+void BatchEvaluator::evaluateSse2(const PackedPosition* positions, size_t count, const Tables& tables,
+    int* scores) const
+{
+    evaluateScalar(positions, count, tables, scores);
+}
+
+void BatchEvaluator::evaluateAvx2(const PackedPosition* positions, size_t count, const Tables& tables,
+    int* scores) const
+{
+    evaluateScalar(positions, count, tables, scores);
+}
+
+#endif
@@ -0,0 +1,414 @@
+#include "Bench.h"
+#include "MiniMax.h"
+#include "AllocationCounter.h"
+#include "Frog.h"
+#include "Snake.h"
+#include "Donkey.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// Both sides' five pieces, player first, each in placement order
+static void createPiecePool(std::vector<std::unique_ptr<Piece>>& pieces)
+{
+    for (PieceOwner owner : { PieceOwner::PLAYER, PieceOwner::AI }) {
+        pieces.push_back(std::make_unique<Frog>(owner, ""));
+        pieces.push_back(std::make_unique<Snake>(owner, ""));
+        pieces.push_back(std::make_unique<Donkey>(owner, ""));
+        pieces.push_back(std::make_unique<Donkey>(owner, ""));
+        pieces.push_back(std::make_unique<Donkey>(owner, ""));
+    }
+}
+
+// FNV-1a over the value's bytes least significant first, so the signature doesn't depend on byte order
+static constexpr uint64_t SIGNATURE_SEED = 14695981039346656037ull;
+
+static uint64_t addToSignature(uint64_t signature, uint64_t value)
+{
+    for (int i = 0; i < 8; i++) signature = (signature ^ ((value >> (8 * i)) & 0xFF)) * 1099511628211ull;
+    return signature;
+}
+
+Bench::Bench(const BenchOptions& options)
+    : m_options(options)
+{
+    createPiecePool(m_pieces);
+}
+
+void Bench::generatePositions()
+{
+    m_positions.clear();
+    std::mt19937_64 rng(m_options.seed);
+
+    while ((int)m_positions.size() < m_options.positions) {
+        GameState state;
+
+        // Same order as a real game: player first, Frog, Snake, then the Donkeys
+        for (int placement = 0; placement < 10; placement++) {
+            int owner = placement % 2;
+            Piece* piece = m_pieces[owner * 5 + placement / 2].get();
+            auto squares = state.getLegalPlacements();
+            const auto& square = squares[rng() % squares.size()];
+            state.applyPlacement(square.first, square.second, piece, false);
+        }
+
+        // Positions already won by placement have nothing to search
+        if (state.getWinner() != PieceOwner::NONE) continue;
+
+        state.setPhase(GamePhase::MOVEMENT);
+        m_positions.push_back(state);
+    }
+}
+
+SearchStats Bench::run()
+{
+    generatePositions();
+
+    MiniMax engine(PieceOwner::PLAYER);
+    engine.setVerbose(false);
+    engine.setSearchFeatures(m_options.features);
+
+    std::vector<SearchStats> results;
+    SearchStats total;
+
+    std::cout << "Bench: " << m_positions.size() << " positions";
+    if (m_options.depth > 0) std::cout << " at depth " << m_options.depth;
+    if (m_options.nodes > 0) std::cout << ", " << m_options.nodes << " nodes each, deterministic";
+    if (m_options.lines > 1) std::cout << ", " << m_options.lines << " lines";
+    std::cout << std::endl;
+
+    SearchLimits limits;
+    limits.depth = m_options.depth;
+    limits.nodes = m_options.nodes;
+    limits.lines = m_options.lines;
+    limits.deterministic = m_options.nodes > 0;
+
+    uint64_t signature = SIGNATURE_SEED;
+    for (size_t i = 0; i < m_positions.size(); i++) {
+        Move move = engine.search(m_positions[i], limits);
+        const SearchStats& stats = engine.getSearchStats();
+        results.push_back(stats);
+        total.add(stats);
+
+        signature = addToSignature(signature, (uint64_t)GameState::Geometry::cell(move.fromCol, move.fromRow));
+        signature = addToSignature(signature, (uint64_t)GameState::Geometry::cell(move.toCol, move.toRow));
+        signature = addToSignature(signature, (uint64_t)(int64_t)stats.score);
+        signature = addToSignature(signature, stats.nodes);
+
+        std::cout << "  " << std::setw(3) << i + 1 << "  score " << std::setw(6) << stats.score
+            << "  nodes " << std::setw(9) << stats.nodes
+            << "  ebf " << std::fixed << std::setprecision(2) << stats.effectiveBranchingFactor()
+            << "  first cut " << std::setprecision(1) << stats.firstMoveCutoffRate() * 100.0 << "%"
+            << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+    total.depth = m_options.depth;
+
+    std::cout << "Nodes: " << total.nodes << "  Time: " << total.micros / 1000 << " ms  NPS: "
+        << (uint64_t)total.nodesPerSecond() << "  First move cutoffs: " << std::fixed << std::setprecision(1)
+        << total.firstMoveCutoffRate() * 100.0 << "%" << std::defaultfloat << std::setprecision(6) << std::endl;
+    std::cout << "Signature: " << std::hex << std::setw(16) << std::setfill('0') << signature << std::dec
+        << std::setfill(' ') << std::endl;
+    if (total.quiescenceNodes > 0) {
+        std::cout << "Threat search nodes: " << total.quiescenceNodes << " (" << std::fixed << std::setprecision(1)
+            << 100.0 * total.quiescenceNodes / total.nodes << "% of all)" << std::defaultfloat << std::setprecision(6)
+            << std::endl;
+    }
+    if (total.forcedNodes > 0) {
+        std::cout << "Forced nodes: " << total.forcedNodes << "  moves skipped: " << total.forcedMovesSkipped
+            << std::endl;
+    }
+
+    if (AllocationCounter::isEnabled()) {
+        std::cout << "Allocations: " << total.allocations << " (" << total.allocatedBytes / 1024 << " KB), "
+            << total.allocations / std::max<size_t>(1, results.size()) << " per search, "
+            << std::fixed << std::setprecision(2) << total.allocationsPerNode() << " per node"
+            << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+    else {
+        std::cout << "Allocations: not counted, build with BOARDGAME_COUNT_ALLOCATIONS" << std::endl;
+    }
+
+    if (!m_options.jsonPath.empty() && !writeJson(results)) {
+        std::cerr << "Failed to write " << m_options.jsonPath << std::endl;
+    }
+    if (!m_options.csvPath.empty() && !writeCsv(results)) {
+        std::cerr << "Failed to write " << m_options.csvPath << std::endl;
+    }
+
+    return total;
+}
+
+bool Bench::writeJson(const std::vector<SearchStats>& results) const
+{
+    std::ofstream file(m_options.jsonPath);
+    if (!file) return false;
+
+    file << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        file << "  ";
+        results[i].writeJson(file);
+        file << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "]\n";
+    return (bool)file;
+}
+
+bool Bench::writeCsv(const std::vector<SearchStats>& results) const
+{
+    std::ofstream file(m_options.csvPath);
+    if (!file) return false;
+
+    file << "position,";
+    SearchStats::writeCsvHeader(file);
+    file << "\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        file << i << ",";
+        results[i].writeCsvRow(file);
+        file << "\n";
+    }
+    return (bool)file;
+}
+
+EvalBench::EvalBench(const EvalBenchOptions& options)
+    : m_options(options)
+{
+    createPiecePool(m_pieces);
+}
+
+void EvalBench::generatePositions()
+{
+    m_states.clear();
+    m_positions.clear();
+    m_states.reserve(m_options.positions);
+    m_positions.reserve(m_options.positions);
+    std::mt19937_64 rng(m_options.seed);
+    Move moves[GameState::MAX_MOVES];
+
+    while ((int)m_states.size() < m_options.positions) {
+        GameState state;
+        for (int placement = 0; placement < 10; placement++) {
+            Piece* piece = m_pieces[(placement % 2) * 5 + placement / 2].get();
+            auto squares = state.getLegalPlacements();
+            const auto& square = squares[rng() % squares.size()];
+            state.applyPlacement(square.first, square.second, piece, false);
+        }
+        state.setPhase(GamePhase::MOVEMENT);
+
+        // Up to 30 random moves, stopping early on a win so the batch holds some finished games too
+        PieceOwner side = PieceOwner::PLAYER;
+        int plies = (int)(rng() % 31);
+        for (int ply = 0; ply < plies && state.getWinner() == PieceOwner::NONE; ply++) {
+            int count = state.generateMoves(side, moves);
+            if (count == 0) break;
+            state.applyMove(moves[rng() % count], false);
+            side = side == PieceOwner::PLAYER ? PieceOwner::AI : PieceOwner::PLAYER;
+        }
+
+        m_states.push_back(state);
+        m_positions.push_back(PackedPosition::fromState(state));
+    }
+}
+
+bool EvalBench::run()
+{
+    generatePositions();
+
+    const EvalParams& params = EvalParams::active();
+    BatchEvaluator evaluator(params);
+    size_t count = m_positions.size();
+    std::vector<int> expected[2], scores(count);
+    const PieceOwner sides[2] = { PieceOwner::PLAYER, PieceOwner::AI };
+
+    for (int s = 0; s < 2; s++) {
+        expected[s].resize(count);
+        for (size_t i = 0; i < count; i++) expected[s][i] = m_states[i].evaluate(sides[s], params);
+    }
+
+    std::cout << "Eval bench: " << count << " positions, " << m_options.rounds << " rounds" << std::endl;
+
+    auto report = [&](const char* name, double seconds) {
+        double evals = (double)count * m_options.rounds;
+        std::cout << "  " << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(8) << evals / seconds / 1e6 << " M evals/s  " << std::setprecision(2)
+            << std::setw(7) << seconds * 1e9 / evals << " ns/eval" << std::defaultfloat << std::setprecision(6);
+    };
+
+    // volatile so the reference loop isn't thrown away
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < m_options.rounds; round++) {
+        for (size_t i = 0; i < count; i++) sink = sink + m_states[i].evaluate(PieceOwner::PLAYER, params);
+    }
+    report("GameState", std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    std::cout << std::endl;
+
+    bool identical = true;
+    for (BatchKernel kernel : { BatchKernel::SCALAR, BatchKernel::SSE2, BatchKernel::AVX2 }) {
+        if (!BatchEvaluator::isSupported(kernel)) {
+            std::cout << "  " << std::left << std::setw(16) << BatchEvaluator::getKernelName(kernel) << std::right
+                << "not supported here" << std::endl;
+            continue;
+        }
+
+        size_t mismatches = 0;
+        for (int s = 0; s < 2; s++) {
+            evaluator.evaluate(m_positions.data(), count, sides[s], scores.data(), kernel);
+            for (size_t i = 0; i < count; i++) mismatches += scores[i] != expected[s][i];
+        }
+
+        start = std::chrono::steady_clock::now();
+        for (int round = 0; round < m_options.rounds; round++) {
+            evaluator.evaluate(m_positions.data(), count, PieceOwner::PLAYER, scores.data(), kernel);
+        }
+        report(BatchEvaluator::getKernelName(kernel),
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        std::cout << "  " << (mismatches == 0 ? "identical" : "MISMATCHES: ")
+            << (mismatches == 0 ? "" : std::to_string(mismatches)) << std::endl;
+        identical = identical && mismatches == 0;
+    }
+
+    std::cout << "Best kernel: " << BatchEvaluator::getKernelName(BatchEvaluator::getBestKernel()) << std::endl;
+    return identical;
+}
+
+RankBench::RankBench(const RankBenchOptions& options)
+    : m_options(options)
+{
+    createPiecePool(m_pieces);
+}
+
+void RankBench::generatePositions()
+{
+    m_states.clear();
+    m_squares.clear();
+    m_states.reserve(m_options.positions);
+    m_squares.reserve(m_options.positions);
+    std::mt19937_64 rng(m_options.seed);
+    Move moves[GameState::MAX_MOVES];
+
+    while ((int)m_states.size() < m_options.positions) {
+        GameState state;
+        for (int placement = 0; placement < 10; placement++) {
+            Piece* piece = m_pieces[(placement % 2) * 5 + placement / 2].get();
+            auto squares = state.getLegalPlacements();
+            const auto& square = squares[rng() % squares.size()];
+            state.applyPlacement(square.first, square.second, piece, false);
+        }
+        state.setPhase(GamePhase::MOVEMENT);
+
+        PieceOwner side = PieceOwner::PLAYER;
+        int plies = (int)(rng() % 31);
+        for (int ply = 0; ply < plies && state.getWinner() == PieceOwner::NONE; ply++) {
+            int count = state.generateMoves(side, moves);
+            if (count == 0) break;
+            state.applyMove(moves[rng() % count], false);
+            side = side == PieceOwner::PLAYER ? PieceOwner::AI : PieceOwner::PLAYER;
+        }
+
+        MaterialSquares squares;
+        MaterialSquares::fromState(state, squares);
+        m_states.push_back(state);
+        m_squares.push_back(squares);
+    }
+}
+
+bool RankBench::run()
+{
+    generatePositions();
+
+    size_t count = m_states.size();
+    Piece* pool[10];
+    for (int i = 0; i < 10; i++) pool[i] = m_pieces[i].get();
+
+    // Checks first: the unranked position is one of the original's symmetric images and ranks back to
+    // the same index, and every image of the original ranks the same
+    size_t roundTripFailures = 0, symmetryFailures = 0;
+    std::vector<uint64_t> indices(count);
+    for (size_t i = 0; i < count; i++) {
+        indices[i] = PositionIndex::rank(m_squares[i]);
+        MaterialSquares unranked;
+        if (!PositionIndex::unrank(indices[i], unranked)) {
+            roundTripFailures++;
+            continue;
+        }
+        GameState state;
+        unranked.applyTo(state, pool);
+        if (PositionIndex::rank(unranked) != indices[i] || state.getCanonicalHash() != m_states[i].getCanonicalHash()) {
+            roundTripFailures++;
+        }
+
+        for (int symmetry = 1; symmetry < GameState::SYMMETRY_COUNT; symmetry++) {
+            auto transform = [symmetry](uint8_t cell) {
+                int col, row;
+                GameState::transformSquare(symmetry, GameState::Geometry::columnOf(cell),
+                    GameState::Geometry::rowOf(cell), col, row);
+                return (uint8_t)GameState::Geometry::cell(col, row);
+            };
+            MaterialSquares image = m_squares[i];
+            for (int side = 0; side < 2; side++) {
+                image.frog[side] = transform(image.frog[side]);
+                image.snake[side] = transform(image.snake[side]);
+                for (uint8_t& cell : image.donkeys[side]) cell = transform(cell);
+            }
+            symmetryFailures += PositionIndex::rank(image) != indices[i];
+        }
+    }
+
+    std::cout << "Rank bench: " << count << " positions, " << m_options.rounds << " rounds" << std::endl;
+
+    auto report = [&](const char* name, double seconds) {
+        double calls = (double)count * m_options.rounds;
+        std::cout << "  " << std::left << std::setw(22) << name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(8) << calls / seconds / 1e6 << " M/s  " << std::setprecision(2)
+            << std::setw(7) << seconds * 1e9 / calls << " ns each" << std::defaultfloat << std::setprecision(6)
+            << std::endl;
+    };
+    auto time = [&](const char* name, auto&& body) {
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < m_options.rounds; round++) {
+            for (size_t i = 0; i < count; i++) body(i);
+        }
+        report(name, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    };
+
+    // volatile so the timed loops aren't thrown away
+    volatile uint64_t sink = 0;
+    time("canonical Zobrist hash", [&](size_t i) { sink = sink + m_states[i].getCanonicalHash(); });
+    time("rank (squares)", [&](size_t i) { sink = sink + PositionIndex::rank(m_squares[i]); });
+    time("rank (GameState)", [&](size_t i) {
+        uint64_t index = 0;
+        PositionIndex::rank(m_states[i], index);
+        sink = sink + index;
+    });
+    time("unrank", [&](size_t i) {
+        MaterialSquares squares;
+        PositionIndex::unrank(indices[i], squares);
+        sink = sink + squares.donkeys[1][2];
+    });
+
+    // Indices no position ranks to, from the positions with the player frog and snake on one symmetry axis
+    std::mt19937_64 rng(m_options.seed);
+    int used = 0;
+    for (int i = 0; i < m_options.indexSamples; i++) {
+        uint64_t index = rng() % PositionIndex::size();
+        MaterialSquares squares;
+        used += PositionIndex::unrank(index, squares) && PositionIndex::rank(squares) == index;
+    }
+
+    double gigabyte = 1024.0 * 1024.0 * 1024.0;
+    uint64_t size = PositionIndex::size();
+    double reachable = (double)used / std::max(1, m_options.indexSamples);
+    std::cout << "Index range: " << size << ", " << std::fixed << std::setprecision(1) << 100.0 * reachable
+        << "% reachable" << std::endl;
+    std::cout << "Per side to move: 2 bit table " << std::setprecision(2) << (double)((size + 31) / 32 * 8) / gigabyte
+        << " GB, hash table of the reachable positions at " << sizeof(TTEntry) << " bytes an entry "
+        << reachable * size * sizeof(TTEntry) / gigabyte << " GB" << std::defaultfloat << std::setprecision(6)
+        << std::endl;
+
+    std::cout << "Round trip failures: " << roundTripFailures << "  symmetry failures: " << symmetryFailures
+        << std::endl;
+    return roundTripFailures == 0 && symmetryFailures == 0;
+}
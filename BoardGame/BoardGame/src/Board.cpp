@@ -1,7 +1,12 @@
 #include "Board.h"
+#include "Profiler.h"
 #include <iostream>
 
+const sf::Color Board::SELECTION_CELL_COLOR(80, 80, 80);
+const sf::Color Board::BOARD_CELL_COLOR(60, 60, 60);
+
 Board::Board()
+    : m_vertices(sf::PrimitiveType::Triangles, CELL_COUNT * (VERTS_PER_FILL + VERTS_PER_OUTLINE))
 {
     initializePieceSelectionGrid();
     initializeGameBoard();
@@ -13,97 +18,109 @@ Board::~Board()
 
 void Board::initializePieceSelectionGrid() //2x5 grid for pieces
 {
-    for (int col = 0; col < 2; col++)
+    for (int col = 0; col < SELECTION_COLUMNS; col++)
     {
-        for (int row = 0; row < 5; row++)
+        for (int row = 0; row < SELECTION_ROWS; row++)
         {
-            GridPos pos{ col, row };
-            sf::RectangleShape cell(sf::Vector2f(CELL_SIZE - 2, CELL_SIZE - 2));
-
-            cell.setPosition({ GRID_OFFSET_X + col * CELL_SIZE, GRID_OFFSET_Y + row * CELL_SIZE });
-
-            cell.setFillColor(sf::Color(80, 80, 80));
-            cell.setOutlineColor(sf::Color::White);
-            cell.setOutlineThickness(2);
-
-            pieceSelectionGrid[pos] = cell;
+            addCell(col * SELECTION_ROWS + row, { GRID_OFFSET_X + col * CELL_SIZE, GRID_OFFSET_Y + row * CELL_SIZE }, SELECTION_CELL_COLOR);
         }
     }
-
-    //std::cout << "selection grid: " << pieceSelectionGrid.size() << " cells" << std::endl;
 }
 
 void Board::initializeGameBoard() //5x5 grid for game
 {
-    for (int col = 0; col < 5; col++)
+    for (int col = 0; col < Geometry::WIDTH; col++)
     {
-        for (int row = 0; row < 5; row++)
+        for (int row = 0; row < Geometry::HEIGHT; row++)
         {
-            GridPos pos{ col, row };
-            sf::RectangleShape cell(sf::Vector2f(CELL_SIZE - 2, CELL_SIZE - 2));
-
-            cell.setPosition({ BOARD_OFFSET_X + col * CELL_SIZE, GRID_OFFSET_Y + row * CELL_SIZE });
-
-            cell.setFillColor(sf::Color(60, 60, 60));
-            cell.setOutlineColor(sf::Color::White);
-            cell.setOutlineThickness(2);
-
-            gameBoard[pos] = cell;
+            addCell(SELECTION_CELLS + Geometry::cell(col, row), { BOARD_OFFSET_X + col * CELL_SIZE, GRID_OFFSET_Y + row * CELL_SIZE }, BOARD_CELL_COLOR);
         }
     }
-
-    //std::cout << "board: " << gameBoard.size() << " tiles" << std::endl;
 }
 
-void Board::render(sf::RenderWindow& window)
+void Board::addCell(int cellIndex, sf::Vector2f position, sf::Color color)
 {
-    //piece selection grid
-    for (int col = 0; col < 2; col++)
-    {
-        for (int row = 0; row < 5; row++)
-        {
-            GridPos pos{ col, row };
-            if (pieceSelectionGrid.find(pos) != pieceSelectionGrid.end()) //get cell in hashmap
-            {
-                window.draw(pieceSelectionGrid[pos]);
-            }
-        }
-    }
+    m_cellPositions[cellIndex] = position;
 
-    //game board grid
-    for (int col = 0; col < 5; col++)
+    // Writes one axis aligned quad as two triangles
+    auto writeQuad = [this](size_t first, float left, float top, float right, float bottom, sf::Color quadColor)
     {
-        for (int row = 0; row < 5; row++)
+        const sf::Vector2f corners[6] = {
+            { left, top }, { right, top }, { right, bottom },
+            { left, top }, { right, bottom }, { left, bottom }
+        };
+        for (int i = 0; i < 6; i++)
         {
-            GridPos pos{ col, row };
-            if (gameBoard.find(pos) != gameBoard.end())
-            {
-                window.draw(gameBoard[pos]);
-            }
+            m_vertices[first + i].position = corners[i];
+            m_vertices[first + i].color = quadColor;
         }
-    }
+    };
+
+    // Same shape the old RectangleShape cells had: 98px fill with a 2px white outline drawn outside it
+    float size = CELL_SIZE - 2;
+    float left = position.x;
+    float top = position.y;
+    float right = left + size;
+    float bottom = top + size;
+    float t = OUTLINE_THICKNESS;
+
+    writeQuad((size_t)cellIndex * VERTS_PER_FILL, left, top, right, bottom, color);
+
+    size_t outline = (size_t)CELL_COUNT * VERTS_PER_FILL + (size_t)cellIndex * VERTS_PER_OUTLINE;
+    writeQuad(outline, left - t, top - t, right + t, top, sf::Color::White);          // top
+    writeQuad(outline + 6, left - t, bottom, right + t, bottom + t, sf::Color::White); // bottom
+    writeQuad(outline + 12, left - t, top, left, bottom, sf::Color::White);           // left
+    writeQuad(outline + 18, right, top, right + t, bottom, sf::Color::White);         // right
+
+    m_cellColors[cellIndex] = color;
+}
+
+void Board::render(sf::RenderWindow& window)
+{
+    PROFILE_FUNCTION();
+    window.draw(m_vertices);
+}
+
+sf::Vector2f Board::getPieceSelectionCellPosition(int col, int row) const
+{
+    return m_cellPositions[col * SELECTION_ROWS + row];
+}
+
+sf::Vector2f Board::getGameBoardCellPosition(int col, int row) const
+{
+    return m_cellPositions[SELECTION_CELLS + Geometry::cell(col, row)];
+}
+
+void Board::setPieceSelectionCellColor(int col, int row, sf::Color color)
+{
+    if (col < 0 || col >= SELECTION_COLUMNS || row < 0 || row >= SELECTION_ROWS) return;
+    setCellColor(col * SELECTION_ROWS + row, color);
 }
 
-sf::RectangleShape* Board::getPieceSelectionCell(int col, int row)
+void Board::setGameBoardCellColor(int col, int row, sf::Color color)
 {
-    GridPos pos{ col, row };
-    auto it = pieceSelectionGrid.find(pos);
-    if (it != pieceSelectionGrid.end())
+    if (!Geometry::contains(col, row)) return;
+    setCellColor(SELECTION_CELLS + Geometry::cell(col, row), color);
+}
+
+void Board::resetCellColors()
+{
+    for (int cell = 0; cell < CELL_COUNT; cell++)
     {
-        return &(it->second);
+        setCellColor(cell, cell < SELECTION_CELLS ? SELECTION_CELL_COLOR : BOARD_CELL_COLOR);
     }
-    return nullptr;
 }
 
-sf::RectangleShape* Board::getGameBoardCell(int col, int row)
+void Board::setCellColor(int cellIndex, sf::Color color)
 {
-    GridPos pos{ col, row };
-    auto it = gameBoard.find(pos);
-    if (it != gameBoard.end())
+    if (m_cellColors[cellIndex] == color) return;
+
+    m_cellColors[cellIndex] = color;
+    size_t first = (size_t)cellIndex * VERTS_PER_FILL;
+    for (size_t i = first; i < first + VERTS_PER_FILL; i++)
     {
-        return &(it->second);
+        m_vertices[i].color = color;
     }
-    return nullptr;
 }
 
 GridPos Board::screenToSelectionGrid(int mouseX, int mouseY) //convert pixel coord to selection grid pos
@@ -123,11 +140,11 @@ GridPos Board::screenToGameBoard(int mouseX, int mouseY) // convert pixel coord
 bool Board::isInSelectionGrid(int mouseX, int mouseY) // ensures the click its inside of the selection grid
 {
     GridPos pos = screenToSelectionGrid(mouseX, mouseY);
-    return (pos.x >= 0 && pos.x < 2 && pos.y >= 0 && pos.y < 5);
+    return (pos.x >= 0 && pos.x < SELECTION_COLUMNS && pos.y >= 0 && pos.y < SELECTION_ROWS);
 }
 
 bool Board::isInGameBoard(int mouseX, int mouseY) // ensures the click its inside of the boaord grid
 {
     GridPos pos = screenToGameBoard(mouseX, mouseY);
-    return (pos.x >= 0 && pos.x < 5 && pos.y >= 0 && pos.y < 5);
+    return Geometry::contains(pos.x, pos.y);
 }
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include "EngineProtocol.h"
+#include "Frog.h"
+#include "Snake.h"
+#include "Donkey.h"
+#include "Notation.h"
+#include <chrono>
+#include <iostream>
+
+EngineProtocol::EngineProtocol(std::istream& in, std::ostream& out, int defaultDepth)
+    : m_in(in)
+    , m_out(out)
+    , m_defaultDepth(defaultDepth)
+    , m_sideToMove(PieceOwner::PLAYER)
+    , m_playerEngine(PieceOwner::PLAYER)
+    , m_aiEngine(PieceOwner::AI)
+    , m_stop(false)
+{
+    // Same pieces as a real game, Frog, Snake and three Donkeys a side, without textures
+    for (PieceOwner owner : { PieceOwner::PLAYER, PieceOwner::AI }) {
+        m_pieces.push_back(std::make_unique<Frog>(owner, ""));
+        m_pieces.push_back(std::make_unique<Snake>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+    }
+
+    m_playerEngine.setVerbose(false);
+    m_aiEngine.setVerbose(false);
+    newGame();
+}
+
+EngineProtocol::~EngineProtocol()
+{
+    stopSearch();
+}
+
+int EngineProtocol::run()
+{
+    std::string line;
+    while (std::getline(m_in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!handleCommand(line)) break;
+    }
+
+    stopSearch();
+    return 0;
+}
+
+bool EngineProtocol::handleCommand(const std::string& line)
+{
+    std::istringstream tokens(line);
+    std::string command;
+    if (!(tokens >> command)) return true;
+
+    if (command == "quit") {
+        return false;
+    }
+    if (command == "isready") {
+        send("readyok");
+        return true;
+    }
+    if (command == "stop") {
+        stopSearch();
+        return true;
+    }
+    if (command == "go") {
+        startSearch(tokens);
+        return true;
+    }
+
+    // Everything below changes or reads the position, which the search thread is using
+    stopSearch();
+
+    if (command == "newgame") {
+        newGame();
+        m_playerEngine.clearHash();
+        m_aiEngine.clearHash();
+    }
+    else if (command == "position") {
+        std::string kind;
+        tokens >> kind;
+        newGame();
+
+        if (kind == "board") {
+            std::string board;
+            tokens >> board;
+            if (!setBoard(board)) {
+                send("info string bad board, expected 25 characters of FSDfsd.");
+                newGame();
+                return true;
+            }
+        }
+        else if (kind != "startpos") {
+            send("info string unknown position " + kind);
+            return true;
+        }
+
+        std::string word;
+        while (tokens >> word) {
+            if (word == "turn") {
+                std::string side;
+                tokens >> side;
+                m_sideToMove = side == "ai" ? PieceOwner::AI : PieceOwner::PLAYER;
+            }
+            else if (word == "moves") {
+                playTokens(tokens, false, false);
+            }
+        }
+    }
+    else if (command == "place") {
+        playTokens(tokens, true, false);
+    }
+    else if (command == "move") {
+        playTokens(tokens, false, true);
+    }
+    else if (command == "d") {
+        printBoard();
+    }
+    else {
+        send("info string unknown command " + command);
+    }
+    return true;
+}
+
+void EngineProtocol::newGame()
+{
+    m_state = GameState();
+    m_state.clearPositionHistory();
+    for (auto& piece : m_pieces) {
+        piece->setGridPosition(-1, -1);
+    }
+    m_sideToMove = PieceOwner::PLAYER;
+}
+
+bool EngineProtocol::setBoard(const std::string& board)
+{
+    std::vector<Piece*> pool;
+    for (auto& piece : m_pieces) pool.push_back(piece.get());
+    if (!Notation::parseBoard(board, pool, m_state, true)) return false;
+
+    // Placement order alternates from the player, so equal counts mean the player is next
+    int placed = countPlaced();
+    if (placed == 10) {
+        m_state.setPhase(GamePhase::MOVEMENT);
+        m_state.recordPosition();
+    }
+    m_sideToMove = (placed % 2 == 0) ? PieceOwner::PLAYER : PieceOwner::AI;
+    return true;
+}
+
+bool EngineProtocol::playTokens(std::istringstream& tokens, bool placementsOnly, bool movesOnly)
+{
+    std::string token;
+    while (tokens >> token) {
+        bool isPlacement = token.size() != 4 || token[1] == '@';
+        if ((placementsOnly && !isPlacement) || (movesOnly && isPlacement) || !playToken(token)) {
+            send("info string illegal " + token);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool EngineProtocol::playToken(const std::string& token)
+{
+    if (m_state.getWinner() != PieceOwner::NONE) return false;
+
+    int col, row;
+    if (token.size() == 4 && token[1] != '@') {
+        int toCol, toRow;
+        return Notation::parseSquare(token.substr(0, 2), col, row)
+            && Notation::parseSquare(token.substr(2, 2), toCol, toRow)
+            && playMove(col, row, toCol, toRow);
+    }
+
+    // "F@c3" names the piece, a bare "c3" takes the next one in order
+    PieceType type = nextPlacementType(m_sideToMove);
+    std::string square = token;
+    if (token.size() == 4) {
+        type = Notation::parsePieceType(token[0]);
+        square = token.substr(2);
+    }
+    return Notation::parseSquare(square, col, row) && playPlacement(type, col, row);
+}
+
+bool EngineProtocol::playPlacement(PieceType type, int col, int row)
+{
+    if (m_state.getCurrentPhase() != GamePhase::PLACEMENT || !m_state.isValidPlacement(col, row)) return false;
+
+    Piece* piece = findUnplaced(m_sideToMove, type);
+    if (!piece) return false;
+
+    m_state.applyPlacement(col, row, piece);
+    if (countPlaced() == 10) {
+        m_state.setPhase(GamePhase::MOVEMENT);
+        m_state.recordPosition();
+    }
+    nextTurn();
+    return true;
+}
+
+bool EngineProtocol::playMove(int fromCol, int fromRow, int toCol, int toRow)
+{
+    if (m_state.getCurrentPhase() != GamePhase::MOVEMENT) return false;
+
+    Piece* piece = m_state.getPieceAt(fromCol, fromRow);
+    if (!piece || piece->getOwner() != m_sideToMove) return false;
+
+    Move move(fromCol, fromRow, toCol, toRow, piece);
+    if (!m_state.isValidMove(move)) return false;
+
+    m_state.applyMove(move);
+    m_state.recordPosition();
+    nextTurn();
+    return true;
+}
+
+void EngineProtocol::nextTurn()
+{
+    m_sideToMove = m_sideToMove == PieceOwner::PLAYER ? PieceOwner::AI : PieceOwner::PLAYER;
+
+    PieceOwner winner = m_state.getWinner();
+    if (winner != PieceOwner::NONE) {
+        send(std::string("info string game over, ") + (winner == PieceOwner::PLAYER ? "player" : "ai") + " wins");
+    }
+}
+
+void EngineProtocol::startSearch(std::istringstream& tokens)
+{
+    stopSearch();
+
+    SearchLimits limits;
+    std::string word;
+    bool infinite = false;
+    while (tokens >> word) {
+        if (word == "depth") tokens >> limits.depth;
+        else if (word == "movetime") tokens >> limits.timeMs;
+        else if (word == "nodes") tokens >> limits.nodes;
+        else if (word == "multipv") tokens >> limits.lines;
+        else if (word == "infinite") infinite = true;
+        else if (word == "deterministic") limits.deterministic = true;
+    }
+    // A deterministic search ignores the clock, without a depth or node budget it would only end on stop
+    bool unbounded = limits.deterministic || (limits.timeMs <= 0 && !infinite);
+    if (limits.depth <= 0 && limits.nodes == 0 && unbounded) limits.depth = m_defaultDepth;
+
+    m_stop = false;
+    limits.stop = &m_stop;
+    PieceOwner side = m_sideToMove;
+
+    if (m_state.getWinner() != PieceOwner::NONE) {
+        send("bestmove none");
+        return;
+    }
+
+    // Placements are a one ply heuristic, nothing to iterate
+    if (m_state.getCurrentPhase() == GamePhase::PLACEMENT) {
+        PieceType type = nextPlacementType(side);
+        Piece* piece = findUnplaced(side, type);
+        MiniMax& engine = engineFor(side);
+        auto [col, row] = engine.findBestPlacement(m_state, piece);
+        const SearchStats& stats = engine.getSearchStats();
+
+        std::ostringstream info;
+        info << "info depth 1 score " << stats.score << " nodes " << stats.nodes;
+        send(info.str());
+        if (col < 0) send("bestmove none");
+        else send(std::string("bestmove ") + "FSD"[(int)type] + "@" + Notation::squareName(col, row));
+        return;
+    }
+
+    bool waitForStop = infinite && !limits.deterministic;
+    m_searchThread = std::thread([this, limits, side, waitForStop]() {
+        MiniMax& engine = engineFor(side);
+        Move best = engine.search(m_state, limits, [this, limits](const SearchInfo& info) {
+            std::ostringstream line;
+            uint64_t nps = info.micros > 0 ? info.nodes * 1000000 / info.micros : 0;
+            line << "info depth " << info.depth;
+            if (limits.lines > 1) line << " multipv " << info.line + 1;
+            line << " score " << info.score << " nodes " << info.nodes
+                << " nps " << nps << " time " << info.micros / 1000 << " pv";
+            for (int i = 0; i < info.pvLength; i++) {
+                line << ' ' << Notation::moveName(info.pv[i]);
+            }
+            send(line.str());
+        });
+
+        // An infinite search answers on stop, also when it ran out of depth first
+        while (waitForStop && !m_stop) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        send(best.piece ? "bestmove " + Notation::moveName(best) : "bestmove none");
+    });
+}
+
+void EngineProtocol::stopSearch()
+{
+    if (m_searchThread.joinable()) {
+        m_stop = true;
+        m_searchThread.join();
+    }
+}
+
+void EngineProtocol::printBoard()
+{
+    std::string squares = Notation::boardString(m_state);
+    std::ostringstream board;
+    for (int row = 4; row >= 0; row--) {
+        board << "info string " << (row + 1) << ' ' << squares.substr(row * 5, 5) << '\n';
+    }
+    board << "info string   abcde\n";
+    board << "info string " << (m_state.getCurrentPhase() == GamePhase::PLACEMENT ? "placement" : "movement")
+        << ", " << (m_sideToMove == PieceOwner::PLAYER ? "player" : "ai") << " to move, board "
+        << squares << ", hash " << std::hex << m_state.getBoardHash();
+    send(board.str());
+}
+
+Piece* EngineProtocol::findUnplaced(PieceOwner owner, PieceType type) const
+{
+    for (const auto& piece : m_pieces) {
+        if (piece->getOwner() == owner && piece->getType() == type && piece->getGridCol() < 0) return piece.get();
+    }
+    return nullptr;
+}
+
+PieceType EngineProtocol::nextPlacementType(PieceOwner owner) const
+{
+    for (PieceType type : { PieceType::FROG, PieceType::SNAKE, PieceType::DONKEY }) {
+        if (findUnplaced(owner, type)) return type;
+    }
+    return PieceType::NONE;
+}
+
+int EngineProtocol::countPlaced() const
+{
+    int placed = 0;
+    for (const auto& piece : m_pieces) {
+        if (piece->getGridCol() >= 0) placed++;
+    }
+    return placed;
+}
+
+void EngineProtocol::send(const std::string& line)
+{
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    m_out << line << std::endl;
+}
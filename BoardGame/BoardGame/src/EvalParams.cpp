@@ -0,0 +1,109 @@
+#include "EvalParams.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+struct NamedWeight {
+    const char* name;
+    int EvalParams::* field;
+};
+
+constexpr NamedWeight WEIGHTS[] = {
+    { "lineThree", &EvalParams::lineThree },
+    { "lineTwo", &EvalParams::lineTwo },
+    { "lineOne", &EvalParams::lineOne },
+    { "offenseWeight", &EvalParams::offenseWeight },
+    { "defenseWeight", &EvalParams::defenseWeight },
+    { "centerWeight", &EvalParams::centerWeight },
+    { "placementCenterWeight", &EvalParams::placementCenterWeight },
+    { "friendlyNeighborWeight", &EvalParams::friendlyNeighborWeight },
+    { "opponentNeighborWeight", &EvalParams::opponentNeighborWeight },
+    { "blockingWeight", &EvalParams::blockingWeight },
+    { "offensiveWeight", &EvalParams::offensiveWeight }
+};
+
+} // namespace
+
+EvalParams& EvalParams::active()
+{
+    static EvalParams params;
+    return params;
+}
+
+bool EvalParams::load(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in) return false;
+
+    // "name value" per line, tables are "name" followed by 25 values row by row, # starts a comment
+    EvalParams loaded = *this;
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(in, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream fields(line);
+        std::string name;
+        if (!(fields >> name)) continue;
+
+        bool known = false;
+        for (const auto& weight : WEIGHTS) {
+            if (name == weight.name) {
+                known = static_cast<bool>(fields >> (loaded.*weight.field));
+            }
+        }
+
+        if (name == "centerValues" || name == "placementValues") {
+            int (&table)[5][5] = (name == "centerValues") ? loaded.centerValues : loaded.placementValues;
+            known = true;
+            for (int row = 0; row < 5 && known; row++) {
+                for (int col = 0; col < 5 && known; col++) {
+                    known = static_cast<bool>(fields >> table[row][col]);
+                }
+            }
+        }
+
+        if (!known) {
+            std::cout << "Params: bad entry on line " << lineNumber << " of " << path << std::endl;
+            return false;
+        }
+    }
+
+    *this = loaded;
+    return true;
+}
+
+bool EvalParams::save(const std::string& path) const
+{
+    std::filesystem::path outPath(path);
+    if (outPath.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(outPath.parent_path(), ec);
+    }
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+
+    out << "# Evaluation weights, written by BoardGame --tune\n";
+    for (const auto& weight : WEIGHTS) {
+        out << weight.name << " " << this->*weight.field << "\n";
+    }
+
+    for (const char* name : { "centerValues", "placementValues" }) {
+        const int (&table)[5][5] = (std::string(name) == "centerValues") ? centerValues : placementValues;
+        out << name;
+        for (int row = 0; row < 5; row++) {
+            for (int col = 0; col < 5; col++) {
+                out << " " << table[row][col];
+            }
+        }
+        out << "\n";
+    }
+
+    return static_cast<bool>(out);
+}
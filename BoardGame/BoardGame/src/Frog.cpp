@@ -55,7 +55,7 @@ bool Frog::canJumpTo(const GameState& state, int fromCol, int fromRow,
     int firstCol = fromCol + dirCol;
     int firstRow = fromRow + dirRow;
 
-    if (firstCol < 0 || firstCol >= 5 || firstRow < 0 || firstRow >= 5) {
+    if (!GameState::Geometry::contains(firstCol, firstRow)) {
         return false;
     }
 
@@ -71,7 +71,7 @@ bool Frog::canJumpTo(const GameState& state, int fromCol, int fromRow,
 
     while (currentCol != toCol || currentRow != toRow) {
         // Bounds check
-        if (currentCol < 0 || currentCol >= 5 || currentRow < 0 || currentRow >= 5) {
+        if (!GameState::Geometry::contains(currentCol, currentRow)) {
             return false;
         }
 
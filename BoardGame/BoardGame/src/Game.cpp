@@ -1,4 +1,6 @@
 #include "Game.h"
+#include "CpuTime.h"
+#include "Profiler.h"
 #include <iostream>
 
 Game::Game() :
@@ -14,14 +16,27 @@ Game::Game() :
     m_aiMoveDelay(0.5f),
     m_waitingForNextMove(false)
 {
-    if (!font.openFromFile("ASSETS/FONTS/Jersey20-Regular.ttf")) 
+    initializePieces();
+    m_gameValid = validateGame();
+    startAssetLoading();
+
+    // Book is optional, generated offline with --build-book
+    if (m_openingBook.load(OpeningBook::DEFAULT_PATH))
     {
-        std::cout << "Error loading font!" << std::endl;
+        m_ai.setOpeningBook(&m_openingBook);
+        m_playerAI.setOpeningBook(&m_openingBook);
+        std::cout << "Opening book loaded (" << m_openingBook.size() << " positions)" << std::endl;
     }
 
-    initializePieces();
-    m_gameValid = validateGame();
 
+    // The GUI engines search a fixed depth 3, where late move reductions, futility pruning and razoring have not
+    // shown a gain (LMR loses about 50 Elo at equal depth), so they keep the full width search
+    SearchFeatures features;
+    features.lateMoveReductions = false;
+    features.futilityPruning = false;
+    features.razoring = false;
+    m_ai.setSearchFeatures(features);
+    m_playerAI.setSearchFeatures(features);
 
     m_gameState.clearPositionHistory();
 
@@ -30,6 +45,64 @@ Game::Game() :
 
 Game::~Game()
 {
+    m_assetLoader.wait();
+}
+
+void Game::startAssetLoading()
+{
+    // Font and every piece image decode in parallel, the window stays responsive meanwhile
+    m_assetLoader.addJob("font", [this] { return font.openFromFile("ASSETS/FONTS/Jersey20-Regular.ttf"); });
+    for (size_t i = 0; i < m_pieceAtlas.getImageCount(); i++) {
+        m_assetLoader.addJob(m_pieceAtlas.getImagePath(i), [this, i] { return m_pieceAtlas.loadImage(i); });
+    }
+    m_assetLoader.start();
+}
+
+void Game::checkAssetsLoaded()
+{
+    if (m_assetsReady) return;
+
+    if (m_assetLoader.isFinished()) {
+        m_assetLoader.wait();
+        m_pieceAtlas.build(); // texture upload has to happen on this thread
+        m_assetsReady = true;
+        m_needsRedraw = true;
+        std::cout << "Assets ready after " << m_startupClock.getElapsedTime().asMilliseconds() << " ms" << std::endl;
+    }
+    else if (m_assetLoader.getCompleted() != m_loadingShown) {
+        m_needsRedraw = true; // progress bar moved
+    }
+}
+
+void Game::setRecordFile(const std::string& path)
+{
+    if (m_recordWriter.open(path)) {
+        std::cout << "Recording game to " << path << std::endl;
+    }
+    else {
+        std::cout << "Error opening record file: " << path << std::endl;
+    }
+}
+
+void Game::recordStats(const MiniMax* engine, int depth, sf::Time elapsed)
+{
+    PlyStats stats;
+    if (engine) {
+        stats.depth = (uint8_t)depth;
+        stats.score = engine->getLastScore();
+        stats.nodes = (uint32_t)engine->getNodesEvaluated();
+        stats.timeMicros = (uint32_t)elapsed.asMicroseconds();
+    }
+    m_record.stats.push_back(stats);
+}
+
+void Game::writeRecord(GameResult result)
+{
+    if (m_recordWritten || !m_recordWriter.isOpen()) return;
+
+    m_record.result = result;
+    m_recordWriter.write(m_record);
+    m_recordWritten = true;
 }
 
 void Game::run()
@@ -45,40 +118,125 @@ void Game::run()
     const float fps{ 60.0f };
     sf::Time timePerFrame = sf::seconds(1.0f / fps);
 
+    sf::Clock wallClock;
+    double lastCpu = getProcessCpuSeconds();
+
     while (window.isOpen())
     {
+        PROFILE_SCOPE("Game::frame");
+
+        checkAssetsLoaded();
+
+        // Nothing to do until the human acts or the AI vs AI delay runs out, so sleep in the OS
+        sf::Time idleWait = m_eventDriven ? getIdleWait() : sf::Time::Zero;
+        if (idleWait > sf::Time::Zero)
+        {
+            if (const std::optional event = window.waitEvent(idleWait))
+            {
+                handleEvent(*event);
+            }
+            // Dont replay the time spent asleep as a burst of updates, and dont run one straight away either,
+            // what woke us (the human's move) gets drawn before update starts the AI thinking
+            clock.restart();
+            timeSinceLastUpdate = sf::Time::Zero;
+        }
+
         processEvents();
         timeSinceLastUpdate += clock.restart();
         while (timeSinceLastUpdate > timePerFrame)
         {
             timeSinceLastUpdate -= timePerFrame;
-            processEvents();
             update(timePerFrame);
         }
-        render();
+
+        bool rendered = !m_eventDriven || m_needsRedraw;
+        if (rendered)
+        {
+            render();
+            m_needsRedraw = false;
+        }
+        else if (!(idleWait > sf::Time::Zero))
+        {
+            sf::sleep(sf::milliseconds(1)); // active but nothing new to show, dont spin
+        }
+
+        double cpu = getProcessCpuSeconds();
+        LoopStats& stats = (idleWait > sf::Time::Zero) ? m_idleStats : m_activeStats;
+        stats.wallSeconds += wallClock.restart().asSeconds();
+        stats.cpuSeconds += cpu - lastCpu;
+        stats.frames += rendered ? 1 : 0;
+        lastCpu = cpu;
+    }
+
+    // Closed or quit with Escape mid game, keep what was played
+    if (m_modeSelected) writeRecord(GameResult::UNFINISHED);
+
+    std::cout << "\nRendering " << (m_eventDriven ? "event driven" : "every frame") << std::endl;
+    printLoopStats("Idle", m_idleStats);
+    printLoopStats("Active", m_activeStats);
+}
+
+void Game::printLoopStats(const char* name, const LoopStats& stats) const
+{
+    if (stats.wallSeconds <= 0.0) return;
+    std::cout << name << ": " << stats.wallSeconds << " s, " << stats.frames << " frames drawn, CPU "
+        << stats.cpuSeconds / stats.wallSeconds * 100.0 << "%" << std::endl;
+}
+
+sf::Time Game::getIdleWait() const
+{
+    const sf::Time NO_WORK = sf::seconds(1.0f); // wake now and then anyway, nothing depends on it
+
+    if (m_needsRedraw || exitGame) return sf::Time::Zero;
+    if (!m_assetsReady) return sf::milliseconds(10); // keep polling the loader
+    if (!m_modeSelected) return NO_WORK;
+
+    // A finished move still has to go through update for the win check
+    bool gameOver = m_gameState.getCurrentPhase() == GamePhase::GAME_OVER;
+    if (!gameOver && m_gameState.getWinner() != PieceOwner::NONE) return sf::Time::Zero;
+    if (gameOver) return NO_WORK;
+
+    if (m_gameMode == GameMode::AI_VS_AI)
+    {
+        if (!m_waitingForNextMove) return sf::Time::Zero;
+        sf::Time remaining = sf::seconds(m_aiMoveDelay) - m_aiMoveTimer.getElapsedTime();
+        return remaining > sf::Time::Zero ? remaining : sf::Time::Zero;
     }
+
+    return m_currentTurn == PieceOwner::PLAYER ? NO_WORK : sf::Time::Zero;
 }
 
 void Game::processEvents()
 {
+    PROFILE_FUNCTION();
     while (const std::optional newEvent = window.pollEvent()) {
-        if (newEvent->is<sf::Event::Closed>()) {
-            exitGame = true;
-        }
-        if (newEvent->is<sf::Event::KeyPressed>()) {
-            processKeys(newEvent);
-        }
-        if (m_modeSelected && m_gameMode == GameMode::PLAYER_VS_AI)
-        {
-            if (newEvent->is<sf::Event::MouseButtonPressed>()) {
-                auto* mouseEvent = newEvent->getIf<sf::Event::MouseButtonPressed>();
-                if (mouseEvent && mouseEvent->button == sf::Mouse::Button::Left) {
-                    handleMouseClick(mouseEvent->position.x, mouseEvent->position.y);
-                }
-                else if (mouseEvent && mouseEvent->button == sf::Mouse::Button::Right) {
-                    m_selectedPiece = nullptr;
-                    clearAllHighlights();
-                }
+        handleEvent(*newEvent);
+    }
+}
+
+void Game::handleEvent(const sf::Event& event)
+{
+    // Pointer movement changes nothing on screen, everything else might
+    if (!event.is<sf::Event::MouseMoved>()) {
+        m_needsRedraw = true;
+    }
+
+    if (event.is<sf::Event::Closed>()) {
+        exitGame = true;
+    }
+    if (event.is<sf::Event::KeyPressed>()) {
+        processKeys(event);
+    }
+    if (m_modeSelected && m_gameMode == GameMode::PLAYER_VS_AI)
+    {
+        if (event.is<sf::Event::MouseButtonPressed>()) {
+            auto* mouseEvent = event.getIf<sf::Event::MouseButtonPressed>();
+            if (mouseEvent && mouseEvent->button == sf::Mouse::Button::Left) {
+                handleMouseClick(mouseEvent->position.x, mouseEvent->position.y);
+            }
+            else if (mouseEvent && mouseEvent->button == sf::Mouse::Button::Right) {
+                m_selectedPiece = nullptr;
+                clearAllHighlights();
             }
         }
     }
@@ -121,6 +279,7 @@ void Game::checkKeyboardState()
 
 void Game::update(sf::Time t_deltaTime)
 {
+    PROFILE_FUNCTION();
     checkKeyboardState();
     if (exitGame)
     {
@@ -142,7 +301,9 @@ void Game::update(sf::Time t_deltaTime)
         else {
             std::cout << "\n=== AI WINS! ===" << std::endl;
         }
+        writeRecord(winner == PieceOwner::PLAYER ? GameResult::PLAYER_WIN : GameResult::AI_WIN);
         m_gameState.setPhase(GamePhase::GAME_OVER);
+        m_needsRedraw = true;
         return;
     }
 
@@ -213,37 +374,39 @@ void Game::executeAIPlacement()
     if (m_aiPiecesPlaced >= 5) return;
 
     Piece* pieceToPlace = m_aiPieces[m_aiPiecesPlaced];
+    sf::Clock searchClock;
     auto placement = m_ai.findBestPlacement(m_gameState, pieceToPlace); // Just a basic heuristc, no need to use full search when board not full
+    sf::Time searchTime = searchClock.getElapsedTime();
 
     if (placement.first >= 0 && placement.second >= 0) {
-        sf::RectangleShape* cell = m_board.getGameBoardCell(placement.first, placement.second);
-        if (cell) {
-            sf::Vector2f cellPos = cell->getPosition();
-            pieceToPlace->setPosition(cellPos.x, cellPos.y);
-            m_gameState.applyPlacement(placement.first, placement.second, pieceToPlace);
-            m_aiPiecesPlaced++;
-
-            std::cout << "AI placed piece at (" << placement.first << ", " << placement.second << ")" << std::endl;
-
-            // Change the phase
-            if (m_playerPiecesPlaced >= 5 && m_aiPiecesPlaced >= 5) {
-                m_gameState.setPhase(GamePhase::MOVEMENT);
-                std::cout << "\n=== Movement Phase Started ===" << std::endl;
-            }
+        sf::Vector2f cellPos = m_board.getGameBoardCellPosition(placement.first, placement.second);
+        pieceToPlace->setPosition(cellPos.x, cellPos.y);
+        m_gameState.applyPlacement(placement.first, placement.second, pieceToPlace);
+        m_aiPiecesPlaced++;
+        m_record.addPlacement(placement.first, placement.second, pieceToPlace->getType());
+        recordStats(&m_ai, 1, searchTime);
+
+        std::cout << "AI placed piece at (" << placement.first << ", " << placement.second << ")" << std::endl;
+
+        // Change the phase
+        if (m_playerPiecesPlaced >= 5 && m_aiPiecesPlaced >= 5) {
+            m_gameState.setPhase(GamePhase::MOVEMENT);
+            std::cout << "\n=== Movement Phase Started ===" << std::endl;
         }
     }
 }
 
 void Game::executeAIMove()
 {
+    sf::Clock searchClock;
     Move aiMove = m_ai.findBestMove(m_gameState, 3);
+    sf::Time searchTime = searchClock.getElapsedTime();
+    recordStats(&m_ai, 3, searchTime);
 
     if (aiMove.piece) {
-        sf::RectangleShape* cell = m_board.getGameBoardCell(aiMove.toCol, aiMove.toRow);
-        if (cell) {
-            sf::Vector2f cellPos = cell->getPosition();
-            aiMove.piece->setPosition(cellPos.x, cellPos.y);
-        }
+        m_record.addMove(aiMove);
+        sf::Vector2f cellPos = m_board.getGameBoardCellPosition(aiMove.toCol, aiMove.toRow);
+        aiMove.piece->setPosition(cellPos.x, cellPos.y);
         m_gameState.applyMove(aiMove);
 
         m_gameState.recordPosition();
@@ -251,20 +414,33 @@ void Game::executeAIMove()
         std::cout << "AI moved from (" << aiMove.fromCol << "," << aiMove.fromRow
             << ") to (" << aiMove.toCol << "," << aiMove.toRow << ")" << std::endl;
     }
+    else {
+        // No legal move, the turn still passes so the record keeps the sides alternating
+        m_record.addPass();
+    }
 }
 
 void Game::render()
 {
+    PROFILE_FUNCTION();
     window.clear(sf::Color::Black);
 
     m_board.render(window);
 
-    // Render all pieces
+    // Render all pieces in one batch from the atlas
+    m_pieceBatch.clear();
     for (auto& piece : m_allPieces) {
-        piece->render(window);
+        piece->appendToBatch(m_pieceBatch, m_pieceAtlas);
+    }
+    if (m_pieceAtlas.isBuilt()) {
+        window.draw(m_pieceBatch, sf::RenderStates(&m_pieceAtlas.getTexture()));
     }
 
-    if (!m_modeSelected)
+    if (!m_assetsReady)
+    {
+        renderLoadingProgress(); // no font yet, modes can still be picked with 1 and 2
+    }
+    else if (!m_modeSelected)
     {
         renderModeSelection();
     }
@@ -274,6 +450,29 @@ void Game::render()
     }
 
     window.display();
+
+    if (!m_firstFrameShown)
+    {
+        m_firstFrameShown = true;
+        std::cout << "First frame after " << m_startupClock.getElapsedTime().asMilliseconds() << " ms ("
+            << m_assetLoader.getCompleted() << "/" << m_assetLoader.getTotal() << " assets loaded)" << std::endl;
+    }
+}
+
+void Game::renderLoadingProgress()
+{
+    m_loadingShown = m_assetLoader.getCompleted();
+
+    sf::RectangleShape background(sf::Vector2f(400.0f, 20.0f));
+    background.setPosition({ 1100.0f, 500.0f });
+    background.setFillColor(sf::Color(60, 60, 60));
+
+    sf::RectangleShape bar(sf::Vector2f(400.0f * m_assetLoader.getProgress(), 20.0f));
+    bar.setPosition({ 1100.0f, 500.0f });
+    bar.setFillColor(sf::Color::White);
+
+    window.draw(background);
+    window.draw(bar);
 }
 
 void Game::renderGameOver()
@@ -312,18 +511,23 @@ void Game::initializePieces()
 
 
     // Player pieces
-    m_allPieces.push_back(std::make_unique<Frog>(PieceOwner::PLAYER, "ASSETS\\IMAGES\\green-frog.png"));
-    m_allPieces.push_back(std::make_unique<Snake>(PieceOwner::PLAYER, "ASSETS\\IMAGES\\green-snake.png"));
-    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::PLAYER, "ASSETS\\IMAGES\\green-donkey.png"));
-    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::PLAYER, "ASSETS\\IMAGES\\green-donkey.png"));
-    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::PLAYER, "ASSETS\\IMAGES\\green-donkey.png"));
+    m_allPieces.push_back(std::make_unique<Frog>(PieceOwner::PLAYER, "ASSETS/IMAGES/green-frog.png"));
+    m_allPieces.push_back(std::make_unique<Snake>(PieceOwner::PLAYER, "ASSETS/IMAGES/green-snake.png"));
+    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::PLAYER, "ASSETS/IMAGES/green-donkey.png"));
+    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::PLAYER, "ASSETS/IMAGES/green-donkey.png"));
+    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::PLAYER, "ASSETS/IMAGES/green-donkey.png"));
 
     // AI pieces
-    m_allPieces.push_back(std::make_unique<Frog>(PieceOwner::AI, "ASSETS\\IMAGES\\red-frog.png"));
-    m_allPieces.push_back(std::make_unique<Snake>(PieceOwner::AI, "ASSETS\\IMAGES\\red-snake.png"));
-    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::AI, "ASSETS\\IMAGES\\red-donkey.png"));
-    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::AI, "ASSETS\\IMAGES\\red-donkey.png"));
-    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::AI, "ASSETS\\IMAGES\\red-donkey.png"));
+    m_allPieces.push_back(std::make_unique<Frog>(PieceOwner::AI, "ASSETS/IMAGES/red-frog.png"));
+    m_allPieces.push_back(std::make_unique<Snake>(PieceOwner::AI, "ASSETS/IMAGES/red-snake.png"));
+    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::AI, "ASSETS/IMAGES/red-donkey.png"));
+    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::AI, "ASSETS/IMAGES/red-donkey.png"));
+    m_allPieces.push_back(std::make_unique<Donkey>(PieceOwner::AI, "ASSETS/IMAGES/red-donkey.png"));
+
+    // Each distinct image is registered once, decoded by the asset loader and packed into the shared atlas
+    for (auto& piece : m_allPieces) {
+        piece->attachToAtlas(m_pieceAtlas);
+    }
 
     // Give the player and ai their pieces from the total pool
     for (size_t i = 0; i < NUM_PIECES; i++) {
@@ -336,20 +540,14 @@ void Game::initializePieces()
     // Position pieces in selection grid - use NEGATIVE grid positions to indicate "not on board"
     for (int i = 0; i < NUM_PIECES; i++) {
         m_playerPieces[i]->setGridPosition(-1, i);  // -1 col means "in selection grid"
-        sf::RectangleShape* cell = m_board.getPieceSelectionCell(0, i);
-        if (cell) {
-            sf::Vector2f cellPos = cell->getPosition();
-            m_playerPieces[i]->setPosition(cellPos.x, cellPos.y);
-        }
+        sf::Vector2f cellPos = m_board.getPieceSelectionCellPosition(0, i);
+        m_playerPieces[i]->setPosition(cellPos.x, cellPos.y);
     }
 
     for (int i = 0; i < NUM_PIECES; i++) {
         m_aiPieces[i]->setGridPosition(-2, i);  // -2 col means "AI selection grid"
-        sf::RectangleShape* cell = m_board.getPieceSelectionCell(1, i);
-        if (cell) {
-            sf::Vector2f cellPos = cell->getPosition();
-            m_aiPieces[i]->setPosition(cellPos.x, cellPos.y);
-        }
+        sf::Vector2f cellPos = m_board.getPieceSelectionCellPosition(1, i);
+        m_aiPieces[i]->setPosition(cellPos.x, cellPos.y);
     }
 
     std::cout << "pieces loaded" << std::endl;
@@ -449,10 +647,7 @@ void Game::selectPieceFromSelectionGrid(GridPos pos)
             m_selectedPiece = piece;
             m_selectedPieceIndex = pos.y;
 
-            sf::RectangleShape* cell = m_board.getPieceSelectionCell(pos.x, pos.y);
-            if (cell) {
-                cell->setFillColor(sf::Color::Yellow);
-            }
+            m_board.setPieceSelectionCellColor(pos.x, pos.y, sf::Color::Yellow);
 
             highlightValidPlacements();
             std::cout << "Selected piece from selection grid row " << pos.y << std::endl;
@@ -470,10 +665,7 @@ void Game::selectPieceFromGameBoard(GridPos pos)
     if (clickedPiece && clickedPiece->getOwner() == PieceOwner::PLAYER) {
         m_selectedPiece = clickedPiece;
 
-        sf::RectangleShape* cell = m_board.getGameBoardCell(pos.x, pos.y);
-        if (cell) {
-            cell->setFillColor(sf::Color::Yellow);
-        }
+        m_board.setGameBoardCellColor(pos.x, pos.y, sf::Color::Yellow);
 
         highlightValidMoves();
         std::cout << "Selected piece at (" << pos.x << ", " << pos.y << ")" << std::endl;
@@ -484,27 +676,26 @@ void Game::placePieceInPlacementPhase(GridPos pos)
 {
     if (!m_selectedPiece) return;
 
-    sf::RectangleShape* cell = m_board.getGameBoardCell(pos.x, pos.y);
-    if (cell) {
-        sf::Vector2f cellPos = cell->getPosition();
-        m_selectedPiece->setPosition(cellPos.x, cellPos.y);
-        m_gameState.applyPlacement(pos.x, pos.y, m_selectedPiece);
-        m_playerPiecesPlaced++;
+    sf::Vector2f cellPos = m_board.getGameBoardCellPosition(pos.x, pos.y);
+    m_selectedPiece->setPosition(cellPos.x, cellPos.y);
+    m_gameState.applyPlacement(pos.x, pos.y, m_selectedPiece);
+    m_playerPiecesPlaced++;
+    m_record.addPlacement(pos.x, pos.y, m_selectedPiece->getType());
+    recordStats(nullptr, 0, sf::Time::Zero);
 
-        std::cout << "Placed piece at (" << pos.x << ", " << pos.y << ")" << std::endl;
+    std::cout << "Placed piece at (" << pos.x << ", " << pos.y << ")" << std::endl;
 
-        clearAllHighlights();
-        m_selectedPiece = nullptr;
-        m_selectedPieceIndex = -1;
-
-        // Check if placement phase is over
-        if (m_playerPiecesPlaced >= 5 && m_aiPiecesPlaced >= 5) {
-            m_gameState.setPhase(GamePhase::MOVEMENT);
-            std::cout << "\n=== Movement Phase Started ===" << std::endl;
-        }
+    clearAllHighlights();
+    m_selectedPiece = nullptr;
+    m_selectedPieceIndex = -1;
 
-        switchTurn();
+    // Check if placement phase is over
+    if (m_playerPiecesPlaced >= 5 && m_aiPiecesPlaced >= 5) {
+        m_gameState.setPhase(GamePhase::MOVEMENT);
+        std::cout << "\n=== Movement Phase Started ===" << std::endl;
     }
+
+    switchTurn();
 }
 
 void Game::movePiece(GridPos pos)
@@ -517,13 +708,12 @@ void Game::movePiece(GridPos pos)
     Move move(fromCol, fromRow, pos.x, pos.y, m_selectedPiece);
 
     if (m_gameState.isValidMove(move)) {
-        sf::RectangleShape* cell = m_board.getGameBoardCell(pos.x, pos.y);
-        if (cell) {
-            sf::Vector2f cellPos = cell->getPosition();
-            m_selectedPiece->setPosition(cellPos.x, cellPos.y);
-        }
+        sf::Vector2f cellPos = m_board.getGameBoardCellPosition(pos.x, pos.y);
+        m_selectedPiece->setPosition(cellPos.x, cellPos.y);
 
         m_gameState.applyMove(move);
+        m_record.addMove(move);
+        recordStats(nullptr, 0, sf::Time::Zero);
 
         m_gameState.recordPosition();
 
@@ -543,10 +733,7 @@ void Game::highlightValidPlacements()
     for (int col = 0; col < 5; col++) {
         for (int row = 0; row < 5; row++) {
             if (m_gameState.isValidPlacement(col, row)) {
-                sf::RectangleShape* cell = m_board.getGameBoardCell(col, row);
-                if (cell) {
-                    cell->setFillColor(sf::Color(100, 255, 100, 150));
-                }
+                m_board.setGameBoardCellColor(col, row, sf::Color(100, 255, 100, 150));
             }
         }
     }
@@ -563,10 +750,7 @@ void Game::highlightValidMoves()
         for (int toRow = 0; toRow < 5; toRow++) {
             Move move(fromCol, fromRow, toCol, toRow, m_selectedPiece);
             if (m_gameState.isValidMove(move)) {
-                sf::RectangleShape* cell = m_board.getGameBoardCell(toCol, toRow);
-                if (cell) {
-                    cell->setFillColor(sf::Color(100, 255, 100, 150));
-                }
+                m_board.setGameBoardCellColor(toCol, toRow, sf::Color(100, 255, 100, 150));
             }
         }
     }
@@ -574,27 +758,12 @@ void Game::highlightValidMoves()
 
 void Game::clearAllHighlights()
 {
-    for (int col = 0; col < 2; col++) {
-        for (int row = 0; row < 5; row++) {
-            sf::RectangleShape* cell = m_board.getPieceSelectionCell(col, row);
-            if (cell) {
-                cell->setFillColor(sf::Color(80, 80, 80));
-            }
-        }
-    }
-
-    for (int col = 0; col < 5; col++) {
-        for (int row = 0; row < 5; row++) {
-            sf::RectangleShape* cell = m_board.getGameBoardCell(col, row);
-            if (cell) {
-                cell->setFillColor(sf::Color(60, 60, 60));
-            }
-        }
-    }
+    m_board.resetCellColors();
 }
 
 void Game::switchTurn()
 {
+    m_needsRedraw = true; // every move and placement ends here
     m_currentTurn = (m_currentTurn == PieceOwner::PLAYER) ? PieceOwner::AI : PieceOwner::PLAYER;
     std::cout << (m_currentTurn == PieceOwner::PLAYER ? "\nPlayer's Turn" : "\nAI's Turn") << std::endl;
 }
@@ -629,41 +798,41 @@ void Game::executePlayerAIPlacement() // Handles Player AI Placement during AI v
     if (m_playerPiecesPlaced >= 5) return;
 
     Piece* pieceToPlace = m_playerPieces[m_playerPiecesPlaced]; //get unplaced piece
+    sf::Clock searchClock;
     auto placement = m_playerAI.findBestPlacement(m_gameState, pieceToPlace); //find best place
+    sf::Time searchTime = searchClock.getElapsedTime();
 
     if (placement.first >= 0 && placement.second >= 0) //verify placement
     {
-        sf::RectangleShape* cell = m_board.getGameBoardCell(placement.first, placement.second);
-        if (cell) 
-        {
-            sf::Vector2f cellPos = cell->getPosition();
-            pieceToPlace->setPosition(cellPos.x, cellPos.y);
-            m_gameState.applyPlacement(placement.first, placement.second, pieceToPlace);
-            m_playerPiecesPlaced++;
+        sf::Vector2f cellPos = m_board.getGameBoardCellPosition(placement.first, placement.second);
+        pieceToPlace->setPosition(cellPos.x, cellPos.y);
+        m_gameState.applyPlacement(placement.first, placement.second, pieceToPlace);
+        m_playerPiecesPlaced++;
+        m_record.addPlacement(placement.first, placement.second, pieceToPlace->getType());
+        recordStats(&m_playerAI, 1, searchTime);
 
-            std::cout << "Player AI placed piece at (" << placement.first << ", " << placement.second << ")" << std::endl;
+        std::cout << "Player AI placed piece at (" << placement.first << ", " << placement.second << ")" << std::endl;
 
-            if (m_playerPiecesPlaced >= 5 && m_aiPiecesPlaced >= 5) //if all pieces are placed move to movement phase
-            {
-                m_gameState.setPhase(GamePhase::MOVEMENT);
-                std::cout << "\n=== Movement Phase Started ===" << std::endl;
-            }
+        if (m_playerPiecesPlaced >= 5 && m_aiPiecesPlaced >= 5) //if all pieces are placed move to movement phase
+        {
+            m_gameState.setPhase(GamePhase::MOVEMENT);
+            std::cout << "\n=== Movement Phase Started ===" << std::endl;
         }
     }
 }
 
 void Game::executePlayerAIMove()
 {
+    sf::Clock searchClock;
     Move playerAIMove = m_playerAI.findBestMove(m_gameState, 3);
+    sf::Time searchTime = searchClock.getElapsedTime();
+    recordStats(&m_playerAI, 3, searchTime);
 
     if (playerAIMove.piece)
     {
-        sf::RectangleShape* cell = m_board.getGameBoardCell(playerAIMove.toCol, playerAIMove.toRow);
-        if (cell)
-        {
-            sf::Vector2f cellPos = cell->getPosition();
-            playerAIMove.piece->setPosition(cellPos.x, cellPos.y);
-        }
+        m_record.addMove(playerAIMove);
+        sf::Vector2f cellPos = m_board.getGameBoardCellPosition(playerAIMove.toCol, playerAIMove.toRow);
+        playerAIMove.piece->setPosition(cellPos.x, cellPos.y);
         m_gameState.applyMove(playerAIMove);
 
         m_gameState.recordPosition();
@@ -671,4 +840,9 @@ void Game::executePlayerAIMove()
         std::cout << "Player AI moved from (" << playerAIMove.fromCol << "," << playerAIMove.fromRow
             << ") to (" << playerAIMove.toCol << "," << playerAIMove.toRow << ")" << std::endl;
     }
+    else
+    {
+        // No legal move, the turn still passes so the record keeps the sides alternating
+        m_record.addPass();
+    }
 }
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "GameRecord.h"
+#include "Piece.h"
+#include <cstring>
+
+namespace {
+    void putVarint(std::vector<uint8_t>& out, uint64_t value)
+    {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            uint8_t byte = *p++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // Varint read straight from the stream, used for the payload size
+    bool readVarint(std::ifstream& file, uint64_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            int byte = file.get();
+            if (byte == EOF) return false;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    uint64_t zigzag(int32_t value) { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+    int32_t unzigzag(uint64_t value) { return (int32_t)((uint32_t)(value >> 1) ^ (0u - (uint32_t)(value & 1))); }
+}
+
+void GameRecord::clear()
+{
+    result = GameResult::DRAW;
+    placements.clear();
+    moves.clear();
+    stats.clear();
+}
+
+void GameRecord::addPlacement(int col, int row, PieceType type)
+{
+    placements.push_back({ (uint8_t)(col * 5 + row), type });
+}
+
+void GameRecord::addMove(const Move& move)
+{
+    moves.push_back({ (uint8_t)(move.fromCol * 5 + move.fromRow), (uint8_t)(move.toCol * 5 + move.toRow) });
+}
+
+void GameRecord::addPass()
+{
+    moves.push_back({ PASS_CELL, PASS_CELL });
+}
+
+GameRecordWriter::GameRecordWriter()
+    : m_gamesWritten(0)
+{
+}
+
+bool GameRecordWriter::open(const std::string& path)
+{
+    close();
+
+    m_file.open(path, std::ios::binary | std::ios::app);
+    if (!m_file) return false;
+
+    // A new file gets the header, an existing one is assumed to be a record file already
+    m_file.seekp(0, std::ios::end);
+    if (m_file.tellp() == 0) {
+        m_file.write(GameRecordFormat::MAGIC, 4);
+        const char version[4] = { (char)GameRecordFormat::VERSION, 0, 0, 0 };
+        m_file.write(version, 4);
+        m_file.flush();
+    }
+
+    return (bool)m_file;
+}
+
+void GameRecordWriter::close()
+{
+    if (m_file.is_open()) m_file.close();
+}
+
+bool GameRecordWriter::write(const GameRecord& record)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_file.is_open()) return false;
+
+    bool hasStats = !record.stats.empty() && (int)record.stats.size() == record.plies();
+
+    std::vector<uint8_t> payload;
+    payload.reserve(8 + record.placements.size() + record.moves.size() * 2 + record.stats.size() * 8);
+    payload.push_back((uint8_t)record.result);
+    payload.push_back(hasStats ? GameRecordFormat::FLAG_STATS : 0);
+    payload.push_back((uint8_t)record.placements.size());
+    putVarint(payload, record.moves.size());
+
+    for (const auto& placement : record.placements) {
+        payload.push_back((uint8_t)(placement.cell | ((int)placement.type << 5)));
+    }
+    for (const auto& move : record.moves) {
+        payload.push_back(move.fromCell);
+        payload.push_back(move.toCell);
+    }
+    if (hasStats) {
+        for (const PlyStats& ply : record.stats) {
+            payload.push_back(ply.depth);
+            putVarint(payload, zigzag(ply.score));
+            putVarint(payload, ply.nodes);
+            putVarint(payload, ply.timeMicros);
+        }
+    }
+
+    m_buffer.clear();
+    putVarint(m_buffer, payload.size());
+    m_buffer.insert(m_buffer.end(), payload.begin(), payload.end());
+
+    m_file.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+    m_file.flush();
+    if (!m_file) return false;
+
+    m_gamesWritten++;
+    return true;
+}
+
+bool GameRecordReader::open(const std::string& path)
+{
+    m_file.open(path, std::ios::binary);
+    if (!m_file) return false;
+
+    char header[8];
+    if (!m_file.read(header, 8) || std::memcmp(header, GameRecordFormat::MAGIC, 4) != 0 ||
+        (uint8_t)header[4] != GameRecordFormat::VERSION) {
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool GameRecordReader::next(GameRecord& record)
+{
+    if (!m_file.is_open()) return false;
+
+    uint64_t size = 0;
+    if (!readVarint(m_file, size) || size == 0 || size > GameRecordFormat::MAX_PAYLOAD) return false;
+
+    m_buffer.resize((size_t)size);
+    if (!m_file.read(reinterpret_cast<char*>(m_buffer.data()), (std::streamsize)size)) return false;
+
+    return decode(record);
+}
+
+bool GameRecordReader::decode(GameRecord& record) const
+{
+    const uint8_t* p = m_buffer.data();
+    const uint8_t* end = p + m_buffer.size();
+
+    record.clear();
+    if (end - p < 3) return false;
+
+    uint8_t result = *p++;
+    uint8_t flags = *p++;
+    uint8_t placementCount = *p++;
+    if (result > (uint8_t)GameResult::UNFINISHED) return false;
+    record.result = (GameResult)result;
+
+    uint64_t moveCount = 0;
+    if (!getVarint(p, end, moveCount)) return false;
+    if ((uint64_t)(end - p) < placementCount + moveCount * 2) return false;
+
+    record.placements.reserve(placementCount);
+    for (int i = 0; i < placementCount; i++) {
+        uint8_t byte = *p++;
+        record.placements.push_back({ (uint8_t)(byte & 0x1F), (PieceType)(byte >> 5) });
+    }
+
+    record.moves.reserve((size_t)moveCount);
+    for (uint64_t i = 0; i < moveCount; i++) {
+        record.moves.push_back({ p[0], p[1] });
+        p += 2;
+    }
+
+    if (flags & GameRecordFormat::FLAG_STATS) {
+        record.stats.resize(placementCount + (size_t)moveCount);
+        for (PlyStats& ply : record.stats) {
+            uint64_t score, nodes, micros;
+            if (p >= end) return false;
+            ply.depth = *p++;
+            if (!getVarint(p, end, score) || !getVarint(p, end, nodes) || !getVarint(p, end, micros)) return false;
+            ply.score = unzigzag(score);
+            ply.nodes = (uint32_t)nodes;
+            ply.timeMicros = (uint32_t)micros;
+        }
+    }
+
+    return p == end;
+}
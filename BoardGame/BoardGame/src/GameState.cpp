@@ -1,74 +1,65 @@
 #include "GameState.h"
 #include <sstream>
+#include <algorithm>
 
-// Pre-compile line check data for win detection and evaluation
-static constexpr int WIN_LINES[24][4] = {
-    // Horizontal lines
-    {0,0,1,0}, {1,0,1,0}, {0,1,1,0}, {1,1,1,0}, {0,2,1,0},
-    {1,2,1,0}, {0,3,1,0}, {1,3,1,0}, {0,4,1,0}, {1,4,1,0},
-    // Vertical lines
-    {0,0,0,1}, {0,1,0,1}, {1,0,0,1}, {1,1,0,1}, {2,0,0,1},
-    {2,1,0,1}, {3,0,0,1}, {3,1,0,1}, {4,0,0,1}, {4,1,0,1},
-    // Diagonal TL-BR (4 total)
-    {0,0,1,1}, {1,0,1,1}, {0,1,1,1}, {1,1,1,1}
-};
-
-// Anti-diagonal lines (TR-BL)
-static constexpr int ANTI_DIAG_LINES[4][4] = {
-    {3,0,-1,1}, {4,0,-1,1}, {3,1,-1,1}, {4,1,-1,1}
-};
-
-static uint64_t ZOBRIST[5][5][3][2];
-static bool zobristInitialized = false;
+// Line, neighbour and Zobrist tables all come from GameState::Geometry
+using Geometry = GameState::Geometry;
+using Rules = GameState::Rules;
+
+// Nothing plays the larger variants yet, instantiating their rules here keeps every member compiling for them
+template class BoardRules<Geometry6x6>;
+template class BoardRules<Geometry7x7>;
+static_assert(BoardRules<Geometry6x6>::MAX_MOVES == 36 && BoardRules<Geometry7x7>::MAX_MOVES == 36,
+    "the same pieces have no more room on a larger board");
 
 GameState::GameState()
     : m_currentPhase(GamePhase::PLACEMENT)
     , m_currentPlayer(PieceOwner::PLAYER)
     , m_winner(PieceOwner::NONE)
     , m_zobristKey(0)  // Initialize member variable
+    , m_network(nullptr)
+    , m_accumulator()
 {
-    for (int col = 0; col < 5; col++) {
-        for (int row = 0; row < 5; row++) {
+    for (int col = 0; col < Geometry::WIDTH; col++) {
+        for (int row = 0; row < Geometry::HEIGHT; row++) {
             m_board[col][row] = nullptr;
         }
     }
-
-    initializeZobrist();
 }
 
 GameState::~GameState() {
 }
 
 bool GameState::isPositionEmpty(int col, int row) const {
-    if (col < 0 || col >= 5 || row < 0 || row >= 5) return false;
+    if (!Geometry::contains(col, row)) return false;
     return m_board[col][row] == nullptr;
 }
 
 Piece* GameState::getPieceAt(int col, int row) const {
-    if (col < 0 || col >= 5 || row < 0 || row >= 5) return nullptr;
+    if (!Geometry::contains(col, row)) return nullptr;
     return m_board[col][row];
 }
 
 void GameState::setPieceAt(int col, int row, Piece* piece) {
-    if (col >= 0 && col < 5 && row >= 0 && row < 5) {
+    if (Geometry::contains(col, row)) {
         m_board[col][row] = piece;
     }
 }
 
 void GameState::removePieceAt(int col, int row) {
-    if (col >= 0 && col < 5 && row >= 0 && row < 5) {
+    if (Geometry::contains(col, row)) {
         m_board[col][row] = nullptr;
     }
 }
 
 bool GameState::isValidPlacement(int col, int row) const {
-    return col >= 0 && col < 5 && row >= 0 && row < 5 && isPositionEmpty(col, row);
+    return Geometry::contains(col, row) && isPositionEmpty(col, row);
 }
 
 bool GameState::isValidMove(const Move& move) const {
     if (!move.piece) return false;
 
-    if (move.toCol < 0 || move.toCol >= 5 || move.toRow < 0 || move.toRow >= 5) {
+    if (!Geometry::contains(move.toCol, move.toRow)) {
         return false;
     }
 
@@ -82,76 +73,21 @@ bool GameState::isValidMove(const Move& move) const {
 }
 
 std::vector<Move> GameState::getLegalMoves(PieceOwner player) const {
-    std::vector<Move> moves;
-    moves.reserve(50);
-
-    for (int fromCol = 0; fromCol < 5; fromCol++) {
-        for (int fromRow = 0; fromRow < 5; fromRow++) {
-            Piece* piece = m_board[fromCol][fromRow];
-            if (!piece || piece->getOwner() != player) continue;
-
-            PieceType type = piece->getType();
-
-            if (type == PieceType::DONKEY) {
-                static constexpr int cardinalDirs[4][2] = { {0,1},{0,-1},{1,0},{-1,0} };
-                for (auto& d : cardinalDirs) {
-                    int tc = fromCol + d[0], tr = fromRow + d[1];
-                    if (tc >= 0 && tc < 5 && tr >= 0 && tr < 5 && !m_board[tc][tr]) {
-                        moves.emplace_back(fromCol, fromRow, tc, tr, piece);
-                    }
-                }
-            }
-            else if (type == PieceType::SNAKE) {
-                static constexpr int allDirs[8][2] = { {-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1} };
-                for (auto& d : allDirs) {
-                    int tc = fromCol + d[0], tr = fromRow + d[1];
-                    if (tc >= 0 && tc < 5 && tr >= 0 && tr < 5 && !m_board[tc][tr]) {
-                        moves.emplace_back(fromCol, fromRow, tc, tr, piece);
-                    }
-                }
-            }
-            else if (type == PieceType::FROG) {
-                static constexpr int allDirs[8][2] = { {-1,-1},{-1,0},{-1,1},{0,-1},{0,1},{1,-1},{1,0},{1,1} };
-
-                for (auto& d : allDirs) {
-                    int tc = fromCol + d[0], tr = fromRow + d[1];
-                    if (tc >= 0 && tc < 5 && tr >= 0 && tr < 5 && !m_board[tc][tr]) {
-                        moves.emplace_back(fromCol, fromRow, tc, tr, piece);
-                    }
-                }
-
-                for (auto& d : allDirs) {
-                    int adjCol = fromCol + d[0], adjRow = fromRow + d[1];
-
-                    if (adjCol < 0 || adjCol >= 5 || adjRow < 0 || adjRow >= 5) continue;
-                    if (!m_board[adjCol][adjRow]) continue;
-
-                    int landCol = adjCol + d[0], landRow = adjRow + d[1];
-
-                    while (landCol >= 0 && landCol < 5 && landRow >= 0 && landRow < 5
-                        && m_board[landCol][landRow]) {
-                        landCol += d[0];
-                        landRow += d[1];
-                    }
-
-                    if (landCol >= 0 && landCol < 5 && landRow >= 0 && landRow < 5
-                        && !m_board[landCol][landRow]) {
-                        moves.emplace_back(fromCol, fromRow, landCol, landRow, piece);
-                    }
-                }
-            }
-        }
-    }
+    Move moves[MAX_MOVES];
+    int count = generateMoves(player, moves);
+    return std::vector<Move>(moves, moves + count);
+}
 
-    return moves;
+int GameState::generateMoves(PieceOwner player, Move* out) const {
+    return Rules::generateMoves(cells(), player, out);
 }
 
 std::vector<std::pair<int, int>> GameState::getLegalPlacements() const {
     std::vector<std::pair<int, int>> placements;
-    placements.reserve(25);
+    placements.reserve(Geometry::CELLS);
 
-    for (int col = 0; col < 5; col++) {
-        for (int row = 0; row < 5; row++) {
+    for (int col = 0; col < Geometry::WIDTH; col++) {
+        for (int row = 0; row < Geometry::HEIGHT; row++) {
             if (!m_board[col][row]) {
                 placements.emplace_back(col, row);
             }
@@ -170,90 +106,61 @@ void GameState::applyMove(const Move& move, bool updatePiecePosition) {
     updateZobrist(piece, move.toCol, move.toRow, true);
     m_board[move.toCol][move.toRow] = piece;
 
+    if (m_network) {
+        m_network->movePiece(m_accumulator, piece, Geometry::cell(move.fromCol, move.fromRow),
+            Geometry::cell(move.toCol, move.toRow));
+    }
+
     if (updatePiecePosition)
     {
         move.piece->setGridPosition(move.toCol, move.toRow); // only move when true (for simulation make sure its false)
     }
 }
 
-void GameState::applyPlacement(int col, int row, Piece* piece) {
-    if (piece && col >= 0 && col < 5 && row >= 0 && row < 5 && !m_board[col][row]) {
+void GameState::applyPlacement(int col, int row, Piece* piece, bool updatePiecePosition) {
+    if (piece && Geometry::contains(col, row) && !m_board[col][row]) {
         updateZobrist(piece, col, row, true);
         m_board[col][row] = piece;
-        piece->setGridPosition(col, row);
-    }
-}
+        if (m_network) m_network->addPiece(m_accumulator, piece, Geometry::cell(col, row));
 
-bool GameState::isWinningState(PieceOwner player) const {
-    // Check horizontal lines
-    for (int row = 0; row < 5; row++) {
-        for (int col = 0; col <= 1; col++) {
-            int count = 0;
-            for (int i = 0; i < 4; i++) {
-                Piece* piece = getPieceAt(col + i, row);
-                if (piece && piece->getOwner() == player) {
-                    count++;
-                }
-                else {
-                    break;
-                }
-            }
-            if (count == 4) return true;
+        if (updatePiecePosition)
+        {
+            piece->setGridPosition(col, row); // keep false when simulating so unplaced pieces stay in the selection grid
         }
     }
+}
 
-    // Check vertical lines
-    for (int col = 0; col < 5; col++) {
-        for (int row = 0; row <= 1; row++) {
-            int count = 0;
-            for (int i = 0; i < 4; i++) {
-                Piece* piece = getPieceAt(col, row + i);
-                if (piece && piece->getOwner() == player) {
-                    count++;
-                }
-                else {
-                    break;
-                }
-            }
-            if (count == 4) return true;
-        }
-    }
+void GameState::undoMove(const Move& move) {
+    if (!move.piece) return;
+    updateZobrist(move.piece, move.toCol, move.toRow, false);
+    m_board[move.toCol][move.toRow] = nullptr;
 
-    // Check diagonal (top-left to bottom-right)
-    for (int col = 0; col <= 1; col++) {
-        for (int row = 0; row <= 1; row++) {
-            int count = 0;
-            for (int i = 0; i < 4; i++) {
-                Piece* piece = getPieceAt(col + i, row + i);
-                if (piece && piece->getOwner() == player) {
-                    count++;
-                }
-                else {
-                    break;
-                }
-            }
-            if (count == 4) return true;
-        }
-    }
+    updateZobrist(move.piece, move.fromCol, move.fromRow, true);
+    m_board[move.fromCol][move.fromRow] = move.piece;
 
-    // Check diagonal (top-right to bottom-left)
-    for (int col = 3; col < 5; col++) {
-        for (int row = 0; row <= 1; row++) {
-            int count = 0;
-            for (int i = 0; i < 4; i++) {
-                Piece* piece = getPieceAt(col - i, row + i);
-                if (piece && piece->getOwner() == player) {
-                    count++;
-                }
-                else {
-                    break;
-                }
-            }
-            if (count == 4) return true;
-        }
+    if (m_network) {
+        m_network->movePiece(m_accumulator, move.piece, Geometry::cell(move.toCol, move.toRow),
+            Geometry::cell(move.fromCol, move.fromRow));
     }
+}
 
-    return false;
+void GameState::copyPosition(const GameState& other) {
+    std::copy(other.cells(), other.cells() + Geometry::CELLS, &m_board[0][0]);
+    m_currentPhase = other.m_currentPhase;
+    m_currentPlayer = other.m_currentPlayer;
+    m_winner = other.m_winner;
+    m_zobristKey = other.m_zobristKey;
+    m_network = other.m_network;
+    m_accumulator = other.m_accumulator;
+}
+
+void GameState::setNetwork(const NeuralNet* network) {
+    m_network = network;
+    if (m_network) m_network->refresh(m_accumulator, cells());
+}
+
+bool GameState::isWinningState(PieceOwner player) const {
+    return Rules::isWinning(cells(), player);
 }
 
 PieceOwner GameState::getWinner() const {
@@ -262,123 +169,151 @@ PieceOwner GameState::getWinner() const {
     return PieceOwner::NONE;
 }
 
-void GameState::initializeZobrist()
-{
-    // Only initialize once globally
-    if (!zobristInitialized) {
-        std::mt19937_64 rng(12345);
-
-        for (int col = 0; col < 5; col++) {
-            for (int row = 0; row < 5; row++) {
-                for (int type = 0; type < 3; type++) {    // Frog, Snake, Donkey
-                    for (int owner = 0; owner < 2; owner++) { // Player, AI
-                        ZOBRIST[col][row][type][owner] = rng();
-                    }
-                }
-            }
-        }
-        zobristInitialized = true;
-    }
-}
-
-bool GameState::checkLine(int startCol, int startRow, int dCol, int dRow, PieceOwner player) const
-{
-    for (int i = 0; i < 4; i++) {
-        Piece* p = m_board[startCol + i * dCol][startRow + i * dRow];
-        if (!p || p->getOwner() != player) return false;
-    }
-    return true;
+int GameState::evaluate(PieceOwner player) const {
+    return evaluate(player, EvalParams::active());
 }
 
+int GameState::evaluate(PieceOwner player, const EvalParams& params) const {
+    // Each side's squares as a mask, read once for the win check and every line
+    Geometry::Mask playerSquares = Rules::ownerMask(cells(), PieceOwner::PLAYER);
+    Geometry::Mask aiSquares = Rules::ownerMask(cells(), PieceOwner::AI);
 
-int GameState::evaluate(PieceOwner player) const {
-    // Check win/loss
-    PieceOwner winner = getWinner();
+    // Check win/loss, in getWinner's order
+    PieceOwner winner = Rules::isWinning(playerSquares) ? PieceOwner::PLAYER
+        : (Rules::isWinning(aiSquares) ? PieceOwner::AI : PieceOwner::NONE);
     if (winner == player) return 10000;
     if (winner != PieceOwner::NONE) return -10000;
 
     int score = 0;
-    PieceOwner opponent = (player == PieceOwner::PLAYER) ? PieceOwner::AI : PieceOwner::PLAYER;
+    Geometry::Mask own = (player == PieceOwner::PLAYER) ? playerSquares : aiSquares;
+    Geometry::Mask opponent = (player == PieceOwner::PLAYER) ? aiSquares : playerSquares;
 
     // Offensive score (player winning lines)
-    score += evaluateLines(player) * 15;
+    score += evaluateLines(own, opponent, params) * params.offenseWeight;
 
     // Defensive score (block opponent's winning lines) - make sure Ai makes this priority
-    score -= evaluateLines(opponent) * 20;
+    score -= evaluateLines(opponent, own, params) * params.defenseWeight;
 
     // Center control differential
-    score += evaluateCenterControl(player) * 3;
-    score -= evaluateCenterControl(opponent) * 3;
+    score += evaluateCenterControl(own, params) * params.centerWeight;
+    score -= evaluateCenterControl(opponent, params) * params.centerWeight;
 
     return score;
 }
 
-int GameState::evaluateLines(PieceOwner player) const {
+int GameState::evaluateLines(Geometry::Mask own, Geometry::Mask opponent, const EvalParams& params) const {
     int score = 0;
 
     // All 4 in a rows
-    for (const auto& line : WIN_LINES) {
-        score += evaluateLine(line[0], line[1], line[2], line[3], player);
+    for (int line = 0; line < Geometry::LINE_COUNT; line++) {
+        score += evaluateLine(line, own, opponent, params);
     }
 
-    // Anti - diagonal checks
-    for (const auto& line : ANTI_DIAG_LINES) {
-        score += evaluateLine(line[0], line[1], line[2], line[3], player);
+    return score;
+}
+
+void GameState::getLineCounts(PieceOwner player, int& threes, int& twos, int& ones) const {
+    int counts[Geometry::LINE_LENGTH + 1] = {};
+    PieceOwner opponent = (player == PieceOwner::PLAYER) ? PieceOwner::AI : PieceOwner::PLAYER;
+    Geometry::Mask own = Rules::ownerMask(cells(), player);
+    Geometry::Mask other = Rules::ownerMask(cells(), opponent);
+
+    for (int line = 0; line < Geometry::LINE_COUNT; line++) {
+        counts[Rules::openLineCount(own, other, line)]++;
     }
 
-    return score;
+    threes = counts[3];
+    twos = counts[2];
+    ones = counts[1];
 }
 
 
-int GameState::evaluateLine(int startCol, int startRow, int dCol, int dRow, PieceOwner player) const {
-    int playerCount = 0;
-    int opponentCount = 0;
-    int emptyCount = 0;
+int GameState::evaluateLine(int line, Geometry::Mask own, Geometry::Mask opponent, const EvalParams& params) const {
+    // Score based on the player count for lines the opponent hasnt blocked
+    switch (Rules::openLineCount(own, opponent, line)) {
+    case 3: return params.lineThree;  // very valuable r
+    case 2: return params.lineTwo;    // mid
+    case 1: return params.lineOne;    // least
+    default: return 0;
+    }
+}
 
-    for (int i = 0; i < 4; i++) {
-        Piece* p = m_board[startCol + i * dCol][startRow + i * dRow];
-        if (p) {
-            if (p->getOwner() == player)
-                playerCount++;
-            else
-                opponentCount++;
+int GameState::getMoveTactics(const Move& move) const {
+    if (!move.piece) return TACTIC_NONE;
+    const auto& tables = Geometry::LINES;
+    Piece* const* board = cells();
+    PieceOwner mover = move.piece->getOwner();
+    int fromCell = Geometry::cell(move.fromCol, move.fromRow);
+    int toCell = Geometry::cell(move.toCol, move.toRow);
+    int tactics = TACTIC_NONE;
+
+    // Counts pieces on a line as they will be after the move, the moving piece included
+    auto countLine = [&](int line, int& own, int& opponent) {
+        Geometry::Mask mask = tables.masks[line];
+        own = (mask >> toCell) & 1;
+        opponent = 0;
+        for (int cell : tables.cells[line]) {
+            if (cell == fromCell || cell == toCell) continue;
+            if (Piece* p = board[cell]) (p->getOwner() == mover ? own : opponent)++;
         }
-        else {
-            emptyCount++;
-        }
-    }
+    };
 
-    // Line blocked by oppoentn
-    if (opponentCount > 0 && playerCount > 0) return 0;
+    for (int i = 0; i < tables.squareLineCount[toCell]; i++) {
+        int own, opponent;
+        countLine(tables.squareLines[toCell][i], own, opponent);
+        if (opponent == 0 && own == Geometry::LINE_LENGTH) tactics |= TACTIC_FOUR;
+        if (opponent == 0 && own == Geometry::LINE_LENGTH - 1) tactics |= TACTIC_THREE;
+        if (own == 1 && opponent == Geometry::LINE_LENGTH - 1) tactics |= TACTIC_BLOCK;
+    }
 
-    // Score based on the player and op counts for lines
-    if (playerCount > 0 && opponentCount == 0) {
-        if (playerCount == 3 && emptyCount == 1) return 150;  // very valuable r
-        if (playerCount == 2 && emptyCount == 2) return 20;   // mid
-        if (playerCount == 1 && emptyCount == 3) return 2;    // least
+    for (int i = 0; i < tables.squareLineCount[fromCell]; i++) {
+        int line = tables.squareLines[fromCell][i];
+        if (tables.masks[line] & ((Geometry::Mask)1 << toCell)) continue; // the piece stays on this line
+        int own, opponent;
+        countLine(line, own, opponent);
+        if (own == 0 && opponent == Geometry::LINE_LENGTH - 1) tactics |= TACTIC_UNBLOCK;
+        if (opponent == 0 && own == Geometry::LINE_LENGTH - 2) tactics |= TACTIC_BREAK;
     }
+    return tactics;
+}
 
-    return 0;
+bool GameState::hasWinningMove(PieceOwner player) const {
+    return Rules::hasWinningMove(cells(), player);
 }
 
+int GameState::filterForcedMoves(PieceOwner player, Move* moves, int count) {
+    int kept = 0;
+    if (hasWinningMove(player)) {
+        for (int i = 0; i < count; i++) {
+            if (getMoveTactics(moves[i]) & TACTIC_FOUR) moves[kept++] = moves[i];
+        }
+        return kept > 0 ? kept : count;
+    }
+
+    PieceOwner opponent = player == PieceOwner::AI ? PieceOwner::PLAYER : PieceOwner::AI;
+    if (!hasWinningMove(opponent)) return count;
+
+    // Each move is tried on the squares alone, the line check never looks at the hash
+    for (int i = 0; i < count; i++) {
+        const Move& move = moves[i];
+        m_board[move.fromCol][move.fromRow] = nullptr;
+        m_board[move.toCol][move.toRow] = move.piece;
+        bool stopsEveryThreat = !hasWinningMove(opponent);
+        m_board[move.toCol][move.toRow] = nullptr;
+        m_board[move.fromCol][move.fromRow] = move.piece;
+        if (stopsEveryThreat) moves[kept++] = move;
+    }
+    return kept > 0 ? kept : count;
+}
 
-int GameState::evaluateCenterControl(PieceOwner player) const {
+int GameState::evaluateCenterControl(Geometry::Mask own, const EvalParams& params) const {
     int score = 0;
 
     // Scoring map for board positions
-    static constexpr int POSITION_VALUES[5][5] = {
-        {1, 2, 3, 2, 1},
-        {2, 4, 5, 4, 2},
-        {3, 5, 8, 5, 3},
-        {2, 4, 5, 4, 2},
-        {1, 2, 3, 2, 1}
-    };
-
-    for (int col = 0; col < 5; col++) {
-        for (int row = 0; row < 5; row++) {
-            Piece* p = m_board[col][row];
-            if (p && p->getOwner() == player) {
-                score += POSITION_VALUES[row][col];
+    for (int col = 0; col < Geometry::WIDTH; col++) {
+        for (int row = 0; row < Geometry::HEIGHT; row++) {
+            if (own & ((Geometry::Mask)1 << Geometry::cell(col, row))) {
+                score += params.centerValues[row][col];
             }
         }
     }
@@ -405,9 +340,46 @@ void GameState::updateZobrist(Piece* piece, int col, int row, bool add)
     int type = (int)piece->getType();    // 02
     int owner = (piece->getOwner() == PieceOwner::PLAYER) ? 0 : 1;
 
-    m_zobristKey ^= ZOBRIST[col][row][type][owner];
+    m_zobristKey ^= Geometry::ZOBRIST.keys[Geometry::cell(col, row)][type][owner];
 }
 
 void GameState::clearPositionHistory() {
     m_positionHistory.clear();
+}
+
+int GameState::inverseSymmetry(int symmetry)
+{
+    // Only the quarter turns are not their own inverse
+    if (symmetry == 1) return 3;
+    if (symmetry == 3) return 1;
+    return symmetry;
+}
+
+uint64_t GameState::getCanonicalHash(int* symmetryOut) const
+{
+    uint64_t hashes[SYMMETRY_COUNT] = {};
+
+    for (int col = 0; col < Geometry::WIDTH; col++) {
+        for (int row = 0; row < Geometry::HEIGHT; row++) {
+            Piece* p = m_board[col][row];
+            if (!p) continue;
+
+            int type = (int)p->getType();
+            int owner = (p->getOwner() == PieceOwner::PLAYER) ? 0 : 1;
+
+            for (int sym = 0; sym < SYMMETRY_COUNT; sym++) {
+                int tc, tr;
+                transformSquare(sym, col, row, tc, tr);
+                hashes[sym] ^= Geometry::ZOBRIST.keys[Geometry::cell(tc, tr)][type][owner];
+            }
+        }
+    }
+
+    int best = 0;
+    for (int sym = 1; sym < SYMMETRY_COUNT; sym++) {
+        if (hashes[sym] < hashes[best]) best = sym;
+    }
+
+    if (symmetryOut) *symmetryOut = best;
+    return hashes[best];
 }
\ No newline at end of file
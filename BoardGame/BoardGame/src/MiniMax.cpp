@@ -1,83 +1,243 @@
 #include "MiniMax.h"
+#include "AllocationCounter.h"
+#include "OpeningBook.h"
+#include "Profiler.h"
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <cstdlib>
 #include <ctime>
 
 MiniMax::MiniMax()
     : m_depth(3)
-    , m_nodesEvaluated(0)
-    , m_pruneCount(0)
+    , m_table(&m_tt)
+    , m_hashSalt(0)
+    , m_aborted(false)
+    , m_canAbort(false)
+    , m_pvLength()
+    , m_rootPvLength(0)
     , m_player(PieceOwner::AI)
+    , m_openingBook(nullptr)
+    , m_verbose(true)
+    , m_params(&EvalParams::active())
+    , m_network(NeuralNet::getActive())
+    , m_history()
 {
+    // Engines share the process wide table choice the way they pick up the active weights and network
+    if (TTBackend::active().isShared()) m_tt.open(TTBackend::active());
 }
 
 MiniMax::MiniMax(PieceOwner player)
     : m_depth(3)
-    , m_nodesEvaluated(0)
-    , m_pruneCount(0)
+    , m_table(&m_tt)
+    , m_hashSalt(0)
+    , m_aborted(false)
+    , m_canAbort(false)
+    , m_pvLength()
+    , m_rootPvLength(0)
     , m_player(player)
+    , m_openingBook(nullptr)
+    , m_verbose(true)
+    , m_params(&EvalParams::active())
+    , m_network(NeuralNet::getActive())
+    , m_history()
 {
+    // Engines share the process wide table choice the way they pick up the active weights and network
+    if (TTBackend::active().isShared()) m_tt.open(TTBackend::active());
 }
 
 MiniMax::~MiniMax() {}
 
-// Main entry point for movement phase
+// Main entry point for movement phase, a full search to a fixed depth
 Move MiniMax::findBestMove(const GameState& state, int depth)
 {
+    SearchLimits limits;
+    limits.depth = depth;
+    return search(state, limits);
+}
+
+Move MiniMax::search(const GameState& state, const SearchLimits& limits,
+    const std::function<void(const SearchInfo&)>& onIteration)
+{
+    PROFILE_FUNCTION();
     resetStatistics();
+    m_searchStart = std::chrono::steady_clock::now();
+    AllocationCounter::Scope allocations;
+    m_limits = limits;
+    m_aborted = false;
+    m_canAbort = false;
+    m_rootPvLength = 0;
+
+    // Nothing an earlier search or another engine left behind may steer a deterministic one, and the clock may
+    // not end it. The engine's own table is kept for the searches after it.
+    if (limits.deterministic) {
+        if (!m_deterministicTt) m_deterministicTt.reset(new TranspositionTable());
+        m_deterministicTt->clear();
+        m_table = m_deterministicTt.get();
+        m_hashSalt = 0;
+        m_limits.timeMs = 0;
+    }
+    else {
+        m_table = &m_tt;
+        m_hashSalt = m_tt.isShared() ? getSettingsFingerprint() : 0;
+    }
 
-    std::vector<Move> legalMoves = state.getLegalMoves(m_player);
+    // Older cutoffs count for less, the positions they came from are further away
+    for (auto& side : m_history) {
+        for (auto& from : side) {
+            for (int& count : from) count = limits.deterministic ? 0 : count / 2;
+        }
+    }
+
+    // Search works on one board with make/unmake and takes its scratch memory from the arena
+    m_arena.reset();
+    m_searchState.copyPosition(state);
+    m_searchState.setNetwork(m_network);
 
-    if (legalMoves.empty()) {
-        std::cout << "MinMax: No legal moves available" << std::endl;
+    Move* legalMoves = m_arena.allocate<Move>(GameState::MAX_MOVES);
+    int moveCount = m_searchState.generateMoves(m_player, legalMoves);
+    m_stats.nodes++;
+    m_stats.nodesPerPly[0]++;
+    m_stats.rootMoves = moveCount;
+
+    if (moveCount == 0) {
+        if (m_verbose) std::cout << "MinMax: No legal moves available" << std::endl;
+        m_lines.clear();
         return Move();
     }
 
-    std::cout << "MinMax: Evaluating " << legalMoves.size() << " moves at depth " << depth << std::endl;
+    // Repetitions only depend on the root move, so they are looked up once for every iteration
+    int* repetitions = m_arena.allocate<int>(GameState::MAX_MOVES);
+    for (int i = 0; i < moveCount; i++) {
+        m_searchState.applyMove(legalMoves[i], false);
+        repetitions[i] = state.getPositionRepetitionCount(m_searchState.getBoardHash());
+        m_searchState.undoMove(legalMoves[i]);
+
+        if (repetitions[i] > 0 && m_verbose) std::cout << "  Move to (" << legalMoves[i].toCol << "," << legalMoves[i].toRow
+            << ") repeats (seen " << repetitions[i] << " times, -" << 2000 * repetitions[i] << ")" << std::endl;
+    }
+
+    int maxDepth = limits.depth > 0 ? std::min(limits.depth, MAX_SEARCH_DEPTH) : MAX_SEARCH_DEPTH;
+    if (m_verbose) std::cout << "MinMax: Evaluating " << moveCount << " moves to depth " << maxDepth << std::endl;
+
+    Move bestMove = legalMoves[0];
+    int bestScore = MIN_SCORE;
+    int completedDepth = 0;
+
+    int lineCount = std::max(1, std::min(limits.lines, moveCount));
+    m_lines.resize(lineCount);
+    m_pendingLines.resize(lineCount);
+
+    // Iterative deepening, each pass starts from the best moves of the one before and the hash moves it left behind
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        // Multi-PV: each line searches the root moves the lines before it did not take. Their subtrees are
+        // already in the hash table, so later lines cost a fraction of the first.
+        for (int line = 0; line < lineCount; line++) {
+            Move lineMove;
+            int lineScore = searchRoot(depth, legalMoves + line, repetitions + line, moveCount - line, lineMove);
+            if (m_aborted) break;
+
+            // Keep the chosen move at this line's slot, so the next pass searches it first as well
+            for (int i = line; i < moveCount; i++) {
+                if (legalMoves[i].fromCol == lineMove.fromCol && legalMoves[i].fromRow == lineMove.fromRow
+                    && legalMoves[i].toCol == lineMove.toCol && legalMoves[i].toRow == lineMove.toRow) {
+                    std::rotate(legalMoves + line, legalMoves + i, legalMoves + i + 1);
+                    std::rotate(repetitions + line, repetitions + i, repetitions + i + 1);
+                    break;
+                }
+            }
+
+            extendPvFromHash(depth);
+            RootLine& pending = m_pendingLines[line];
+            pending.move = lineMove;
+            pending.score = lineScore;
+            pending.pv.assign(m_rootPv, m_rootPv + m_rootPvLength);
+        }
+        if (m_aborted) break; // a half finished pass would mix depths between lines
+
+        m_lines.swap(m_pendingLines);
+        bestMove = m_lines[0].move;
+        bestScore = m_lines[0].score;
+        completedDepth = depth;
+        m_canAbort = true; // one finished pass guarantees a move, later ones may be cut short
+
+        uint64_t micros = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_searchStart).count();
+        m_stats.iterations.push_back({ depth, bestScore, m_stats.nodes, micros });
+
+        if (onIteration) {
+            for (int line = 0; line < lineCount; line++) {
+                const RootLine& rootLine = m_lines[line];
+                SearchInfo info{ depth, rootLine.score, m_stats.nodes, micros,
+                    rootLine.pv.data(), (int)rootLine.pv.size(), line };
+                onIteration(info);
+            }
+        }
+
+        if (m_limits.timeMs > 0 && (int64_t)(micros / 1000) * 2 > m_limits.timeMs) break; // next pass would not finish
+    }
+
+    if (m_verbose) std::cout << "Selected move (score: " << bestScore << ", depth " << completedDepth << ")" << std::endl;
+
+    m_stats.micros = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - m_searchStart).count();
+    m_stats.depth = completedDepth;
+    m_stats.score = bestScore;
+    m_stats.allocations = allocations.since().allocations;
+    m_stats.allocatedBytes = allocations.since().bytes;
+
+    if (m_verbose) std::cout << "MiniMax: Nodes evaluated = " << m_stats.nodes
+        << " | Branches pruned = " << m_stats.cutoffs
+        << " | EBF = " << m_stats.effectiveBranchingFactor()
+        << " | NPS = " << (uint64_t)m_stats.nodesPerSecond() << std::endl;
+
+    return bestMove;
+}
+
+int MiniMax::searchRoot(int depth, const Move* moves, const int* repetitions, int moveCount, Move& bestMove)
+{
+    m_depth = depth;
 
     // Track best moves & repeated moves
-    Move bestMove;
     int bestScore = MIN_SCORE;
     Move bestNonRepeatingMove;
     int bestNonRepeatingScore = MIN_SCORE;
     bool foundNonRepeating = false;
+    Move bestPv[SearchStats::MAX_PLY];
+    int bestPvLength = 0;
+    Move nonRepeatingPv[SearchStats::MAX_PLY];
+    int nonRepeatingPvLength = 0;
 
     int alpha = MIN_SCORE;
     int beta = MAX_SCORE;
 
     // Evaluate each move
-    for (const Move& move : legalMoves) {
-        GameState simulatedState = state;
-        simulatedState.applyMove(move, false);
-
-        // Check if this position was seen before
-        uint64_t positionHash = simulatedState.getBoardHash();
-        int repetitionCount = state.getPositionRepetitionCount(positionHash);
+    for (int i = 0; i < moveCount; i++) {
+        const Move& move = moves[i];
+        m_searchState.applyMove(move, false);
 
         // Calculate score using minimax
-        int moveScore = alphaBeta(simulatedState, depth - 1, alpha, beta, false, m_player);
+        int moveScore = alphaBeta(depth - 1, 1, alpha, beta, false, m_player);
+        m_searchState.undoMove(move);
+        if (m_aborted) return 0;
 
         // Apply penalty if position repeats
-        if (repetitionCount > 0) {
-            int penalty = 2000 * repetitionCount;
-            moveScore -= penalty;
-            std::cout << "  Move to (" << move.toCol << "," << move.toRow
-                << ") repeats (seen " << repetitionCount << " times, -" << penalty << ")" << std::endl;
-        }
+        moveScore -= 2000 * repetitions[i];
 
         // Track overall best move
         if (moveScore > bestScore) {
             bestScore = moveScore;
             bestMove = move;
+            bestPvLength = copyPv(move, bestPv);
         }
 
         // Track best non-repeating move separately
-        if (repetitionCount == 0) {
+        if (repetitions[i] == 0) {
             if (moveScore > bestNonRepeatingScore) {
                 bestNonRepeatingScore = moveScore;
                 bestNonRepeatingMove = move;
                 foundNonRepeating = true;
+                nonRepeatingPvLength = copyPv(move, nonRepeatingPv);
             }
             alpha = std::max(alpha, moveScore);
         }
@@ -85,22 +245,87 @@ Move MiniMax::findBestMove(const GameState& state, int depth)
 
     // Prefer non-repeating moves if available
     if (foundNonRepeating) {
-        std::cout << "Selected non-repeating move (score: " << bestNonRepeatingScore << ")" << std::endl;
         bestMove = bestNonRepeatingMove;
         bestScore = bestNonRepeatingScore;
+        std::copy(nonRepeatingPv, nonRepeatingPv + nonRepeatingPvLength, m_rootPv);
+        m_rootPvLength = nonRepeatingPvLength;
     }
     else {
-        std::cout << "All moves repeat - chose least bad (score: " << bestScore << ")" << std::endl;
+        std::copy(bestPv, bestPv + bestPvLength, m_rootPv);
+        m_rootPvLength = bestPvLength;
     }
 
-    std::cout << "MiniMax: Nodes evaluated = " << m_nodesEvaluated
-        << " | Branches pruned = " << m_pruneCount << std::endl;
+    return bestScore;
+}
 
-    return bestMove;
+// Root move followed by the line the search below it just returned
+int MiniMax::copyPv(const Move& rootMove, Move* out) const
+{
+    out[0] = rootMove;
+    int length = 1;
+    for (int ply = 1; ply < m_pvLength[1]; ply++) {
+        out[length++] = m_pv[1][ply];
+    }
+    return length;
+}
+
+// Hash cutoffs end the line where they happen, so a warm table leaves short PVs.
+// The rest is read back from the hash moves, each one checked for legality.
+void MiniMax::extendPvFromHash(int depth)
+{
+    int applied = 0;
+    for (; applied < m_rootPvLength; applied++) {
+        m_searchState.applyMove(m_rootPv[applied], false);
+    }
+
+    while (m_rootPvLength < depth && m_searchState.getWinner() == PieceOwner::NONE) {
+        PieceOwner side = (m_rootPvLength % 2 == 0) ? m_player : getOpponent(m_player);
+        uint64_t key = hashKey(m_searchState, side);
+
+        TTEntry entry;
+        if (!m_table->probe(key, entry) || entry.fromCell == TranspositionTable::NO_CELL) break;
+
+        using Geometry = GameState::Geometry;
+        Piece* piece = m_searchState.getPieceAt(Geometry::columnOf(entry.fromCell), Geometry::rowOf(entry.fromCell));
+        Move move(Geometry::columnOf(entry.fromCell), Geometry::rowOf(entry.fromCell),
+            Geometry::columnOf(entry.toCell), Geometry::rowOf(entry.toCell), piece);
+        if (!piece || piece->getOwner() != side || !m_searchState.isValidMove(move)) break;
+
+        m_searchState.applyMove(move, false);
+        m_rootPv[m_rootPvLength++] = move;
+        applied++;
+    }
+
+    while (applied > 0) {
+        m_searchState.undoMove(m_rootPv[--applied]);
+    }
+}
+
+std::vector<Move> MiniMax::getPrincipalVariation() const
+{
+    return m_lines.empty() ? std::vector<Move>() : m_lines[0].pv;
+}
+
+// Stop flag every node is too slow to read, the clock even more so
+bool MiniMax::shouldAbort()
+{
+    if (!m_canAbort) return false;
+    if (m_limits.nodes > 0 && m_stats.nodes >= m_limits.nodes) return true;
+    if ((m_stats.nodes & 1023) != 0) return false;
+
+    if (m_limits.stop && m_limits.stop->load(std::memory_order_relaxed)) return true;
+    if (m_limits.timeMs > 0) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_searchStart);
+        if (elapsed.count() >= m_limits.timeMs) return true;
+    }
+    return false;
 }
 
 std::pair<int, int> MiniMax::findBestPlacement(const GameState& state, Piece* piece)
 {
+    PROFILE_FUNCTION();
+    resetStatistics();
+
     if (!piece) {
         return { -1, -1 };
     }
@@ -111,11 +336,21 @@ std::pair<int, int> MiniMax::findBestPlacement(const GameState& state, Piece* pi
         return { -1, -1 };
     }
 
+    // Early placements come straight from the book when it has them
+    if (m_openingBook) {
+        int bookCol, bookRow;
+        if (m_openingBook->probe(state, piece, bookCol, bookRow)) {
+            if (m_verbose) std::cout << "MinMax: Book placement (" << bookCol << "," << bookRow << ")" << std::endl;
+            return { bookCol, bookRow };
+        }
+    }
+
     std::pair<int, int> bestPosition = availablePositions[0];
     int bestScore = MIN_SCORE;
 
     for (const auto& [col, row] : availablePositions) {
         int score = evaluatePosition(state, col, row, piece);
+        m_stats.nodes++;
 
         if (score > bestScore) {
             bestScore = score;
@@ -123,28 +358,50 @@ std::pair<int, int> MiniMax::findBestPlacement(const GameState& state, Piece* pi
         }
     }
 
+    m_stats.depth = 1;
+    m_stats.score = bestScore;
     return bestPosition;
 }
 
 int MiniMax::evaluatePosition(const GameState& state, int col, int row, Piece* piece)
+{
+    PlacementFeatures features;
+    getPlacementFeatures(state, col, row, piece, features);
+    return scorePlacement(features, col, row, *m_params);
+}
+
+int MiniMax::scorePlacement(const PlacementFeatures& features, int col, int row, const EvalParams& params)
 {
     int score = 0;
-    PieceOwner opponent = getOpponent(m_player);
 
     // F1: Strategic position value
-    static constexpr int POSITION_VALUES[5][5] = {
-        {2, 3, 4, 3, 2},
-        {3, 5, 6, 5, 3},
-        {4, 6, 10, 6, 4},
-        {3, 5, 6, 5, 3},
-        {2, 3, 4, 3, 2}
-    };
-    score += POSITION_VALUES[row][col] * 8;
+    score += params.placementValues[row][col] * params.placementCenterWeight;
+
+    // F2: Board state after the placement
+    score += features.evalAfter / 3;
+
+    // F3: Piece adjacency
+    score += features.friendlyNeighbors * params.friendlyNeighborWeight;
+    score += features.opponentNeighbors * params.opponentNeighborWeight;
+
+    // F4: Blocking potential
+    score += features.blocking * params.blockingWeight;
+
+    // F5: Offensive potential
+    score += features.offensive * params.offensiveWeight;
+
+    return score;
+}
+
+void MiniMax::getPlacementFeatures(const GameState& state, int col, int row, Piece* piece,
+    PlacementFeatures& features) const
+{
+    PieceOwner opponent = getOpponent(m_player);
 
     // F2: Simulate placement and evaluate board state
     GameState simulatedState = state;
-    simulatedState.applyPlacement(col, row, piece);
-    score += simulatedState.evaluate(m_player) / 3;
+    simulatedState.applyPlacement(col, row, piece, false);
+    features.evalAfter = simulatedState.evaluate(m_player, *m_params);
 
     // F3: Friendly piece adjacency
     const int DIRECTIONS[8][2] = {
@@ -173,18 +430,14 @@ int MiniMax::evaluatePosition(const GameState& state, int col, int row, Piece* p
         }
     }
 
-    score += friendlyNeighbors * 12;
-    score += opponentNeighbors * 8;
+    features.friendlyNeighbors = friendlyNeighbors;
+    features.opponentNeighbors = opponentNeighbors;
 
     // F4: Blocking potential
-    int blockingValue = evaluateBlockingPotential(state, col, row, opponent);
-    score += blockingValue * 25;
+    features.blocking = evaluateBlockingPotential(state, col, row, opponent);
 
     // F5: Offensive potential
-    int offensiveValue = evaluateOffensivePotential(state, col, row, piece);
-    score += offensiveValue * 15;
-
-    return score;
+    features.offensive = evaluateOffensivePotential(state, col, row, piece);
 }
 
 int MiniMax::evaluateBlockingPotential(const GameState& state, int col, int row, PieceOwner opponent) const
@@ -269,10 +522,18 @@ int MiniMax::evaluateOffensivePotential(const GameState& state, int col, int row
     return offensiveValue;
 }
 
-int MiniMax::alphaBeta(const GameState& state, int depth, int alpha, int beta,
-    bool isMaximizingPlayer, PieceOwner aiPlayer)
+int MiniMax::alphaBeta(int depth, int ply, int alpha, int beta, bool isMaximizingPlayer, PieceOwner aiPlayer)
 {
-    m_nodesEvaluated++;
+    const GameState& state = m_searchState;
+    m_pvLength[ply] = ply;
+
+    if (m_aborted || shouldAbort()) {
+        m_aborted = true;
+        return 0;
+    }
+
+    m_stats.nodes++;
+    m_stats.nodesPerPly[ply]++;
 
     PieceOwner winner = state.getWinner();
     if (winner == aiPlayer) {
@@ -282,43 +543,281 @@ int MiniMax::alphaBeta(const GameState& state, int depth, int alpha, int beta,
         return LOSS_SCORE - depth;
     }
 
-    if (depth == 0) {
-        return state.evaluate(aiPlayer);
+    if (depth <= 0) {
+        return m_features.threatSearch ? quiescence(ply, 0, alpha, beta, isMaximizingPlayer, aiPlayer)
+            : staticEval(aiPlayer, isMaximizingPlayer);
     }
 
     PieceOwner currentPlayer = isMaximizingPlayer ? aiPlayer : getOpponent(aiPlayer);
-    std::vector<Move> possibleMoves = state.getLegalMoves(currentPlayer);
 
-    if (possibleMoves.empty()) {
-        return state.evaluate(aiPlayer);
+    uint64_t key = hashKey(state, currentPlayer);
+    TTEntry entry;
+    uint8_t hashFrom = TranspositionTable::NO_CELL, hashTo = TranspositionTable::NO_CELL;
+    m_stats.ttProbes++;
+    if (m_table->probe(key, entry)) {
+        m_stats.ttHits++;
+        hashFrom = entry.fromCell;
+        hashTo = entry.toCell;
+        if (entry.depth >= depth) {
+            // Stored for the side to move, the minimizing side's bounds turn over with the sign
+            int hashScore = isMaximizingPlayer ? entry.score : -entry.score;
+            TTBound atLeast = isMaximizingPlayer ? TTBound::LOWER : TTBound::UPPER;
+            if (entry.bound == TTBound::EXACT) return hashScore;
+            if (entry.bound == atLeast && hashScore >= beta) return hashScore;
+            if (entry.bound != atLeast && hashScore <= alpha) return hashScore;
+        }
+    }
+
+    // Move list lives until this node returns
+    SearchArena::Mark mark = m_arena.mark();
+    Move* possibleMoves = m_arena.allocate<Move>(GameState::MAX_MOVES);
+    int moveCount = state.generateMoves(currentPlayer, possibleMoves);
+
+    // A win on the board or one to stop leaves only a handful of moves worth a look, and none of them may be pruned
+    bool forced = false;
+    if (m_features.forcedMoves) {
+        int forcedCount = m_searchState.filterForcedMoves(currentPlayer, possibleMoves, moveCount);
+        forced = forcedCount < moveCount;
+        if (forced) {
+            m_stats.forcedNodes++;
+            m_stats.forcedMovesSkipped += moveCount - forcedCount;
+            moveCount = forcedCount;
+        }
+    }
+
+    orderMoves(possibleMoves, moveCount, currentPlayer, hashFrom, hashTo);
+
+    // Frontier nodes whose static score is far on the wrong side of the window. Quiet moves shift the
+    // evaluation by less than the margins in all but a handful of positions, so they are not worth searching.
+    bool hopelessFrontier = false;
+    bool razored = false;
+    int score = 0;
+    int bestIndex = -1;
+    if (moveCount > 0 && !forced
+        && ((depth == 1 && m_features.futilityPruning) || (depth == 2 && m_features.razoring))) {
+        int staticScore = staticEval(aiPlayer, isMaximizingPlayer);
+        int margin = depth == 1 ? m_features.futilityMargin : m_features.razorMargin;
+        bool hopeless = isMaximizingPlayer ? staticScore + margin <= alpha : staticScore - margin >= beta;
+
+        if (hopeless && depth == 1) {
+            hopelessFrontier = true;
+        }
+        else if (hopeless) {
+            // Razoring: a one ply search that agrees the node fails is trusted instead of the full one
+            score = isMaximizingPlayer
+                ? maximizeScore(possibleMoves, moveCount, 1, ply, alpha, beta, aiPlayer, true, bestIndex)
+                : minimizeScore(possibleMoves, moveCount, 1, ply, alpha, beta, aiPlayer, true, bestIndex);
+            razored = !m_aborted && (isMaximizingPlayer ? score <= alpha : score >= beta);
+            if (razored) m_stats.razorCuts++;
+            bestIndex = razored ? bestIndex : -1;
+        }
+    }
+
+    if (moveCount == 0) {
+        score = staticEval(aiPlayer, isMaximizingPlayer);
+    }
+    else if (razored) {
+        // score and bestIndex already hold the shallow result
+    }
+    else if (isMaximizingPlayer) {
+        score = maximizeScore(possibleMoves, moveCount, depth, ply, alpha, beta, aiPlayer, hopelessFrontier,
+            bestIndex);
+    }
+    else {
+        score = minimizeScore(possibleMoves, moveCount, depth, ply, alpha, beta, aiPlayer, hopelessFrontier,
+            bestIndex);
+    }
+
+    // An aborted subtree returns garbage, keep it out of the table
+    if (!m_aborted) {
+        TTBound bound = score <= alpha ? TTBound::UPPER : (score >= beta ? TTBound::LOWER : TTBound::EXACT);
+        // Skipped quiet moves could only have helped the side to move, so a score inside the window is a bound
+        // as well: at least this for the maximizer, at most this for the minimizer
+        if (hopelessFrontier && bound == TTBound::EXACT) {
+            bound = isMaximizingPlayer ? TTBound::LOWER : TTBound::UPPER;
+        }
+        if (!isMaximizingPlayer && bound != TTBound::EXACT) {
+            bound = bound == TTBound::UPPER ? TTBound::LOWER : TTBound::UPPER;
+        }
+        uint8_t fromCell = TranspositionTable::NO_CELL, toCell = TranspositionTable::NO_CELL;
+        if (bestIndex >= 0) {
+            const Move& best = possibleMoves[bestIndex];
+            fromCell = (uint8_t)GameState::Geometry::cell(best.fromCol, best.fromRow);
+            toCell = (uint8_t)GameState::Geometry::cell(best.toCol, best.toRow);
+        }
+        m_table->store(key, isMaximizingPlayer ? score : -score, depth, bound, fromCell, toCell);
+    }
+
+    m_arena.rewind(mark);
+    return score;
+}
+
+// Hash move first, it was best the last time this position was searched. The rest by how often they caused
+// cutoffs elsewhere in the tree (history heuristic), so the moves late move reductions hit are the unlikely ones.
+void MiniMax::orderMoves(Move* moves, int moveCount, PieceOwner side, uint8_t hashFrom, uint8_t hashTo) const
+{
+    const int (*history)[GameState::Geometry::CELLS] = m_history[side == PieceOwner::AI ? 1 : 0];
+    int scores[GameState::MAX_MOVES];
+    for (int i = 0; i < moveCount; i++) {
+        int from = GameState::Geometry::cell(moves[i].fromCol, moves[i].fromRow);
+        int to = GameState::Geometry::cell(moves[i].toCol, moves[i].toRow);
+        scores[i] = (from == hashFrom && to == hashTo) ? std::numeric_limits<int>::max() : history[from][to];
+    }
+
+    // Insertion sort, stable and quick for a few dozen moves
+    for (int i = 1; i < moveCount; i++) {
+        Move move = moves[i];
+        int score = scores[i];
+        int j = i - 1;
+        while (j >= 0 && scores[j] < score) {
+            moves[j + 1] = moves[j];
+            scores[j + 1] = scores[j];
+            j--;
+        }
+        moves[j + 1] = move;
+        scores[j + 1] = score;
+    }
+}
+
+void MiniMax::recordCutoff(const Move& move, PieceOwner side, int depth)
+{
+    int& entry = m_history[side == PieceOwner::AI ? 1 : 0][GameState::Geometry::cell(move.fromCol, move.fromRow)]
+        [GameState::Geometry::cell(move.toCol, move.toRow)];
+    entry += depth * depth;
+}
+
+// Finished games are scored by the callers before they get here, so the network doesn't have to spot them.
+// The network was trained on results for the side to move, so it is asked from that side and flipped.
+int MiniMax::staticEval(PieceOwner aiPlayer, bool aiToMove) const
+{
+    if (!m_network) return m_searchState.evaluate(aiPlayer, *m_params);
+
+    PieceOwner toMove = aiToMove ? aiPlayer : getOpponent(aiPlayer);
+    int score = m_searchState.evaluateNetwork(toMove);
+    return aiToMove ? score : -score;
+}
+
+// Past the nominal depth only forcing moves are played: fours, new threes and blocks of the opponent's threes.
+// New threes only on the first extra ply, after that just the win and the replies to it, so threat chains stay
+// short. The side to move can always stand pat on the static score instead, and QUIESCENCE_PLIES is a hard cap.
+// The first call is for a node alphaBeta has already counted and checked for a win.
+int MiniMax::quiescence(int ply, int qDepth, int alpha, int beta, bool isMaximizingPlayer, PieceOwner aiPlayer)
+{
+    const GameState& state = m_searchState;
+    m_pvLength[ply] = ply;
+
+    if (qDepth > 0) {
+        if (m_aborted || shouldAbort()) {
+            m_aborted = true;
+            return 0;
+        }
+
+        m_stats.nodes++;
+        m_stats.quiescenceNodes++;
+        m_stats.nodesPerPly[ply]++;
+
+        PieceOwner winner = state.getWinner();
+        if (winner == aiPlayer) return WIN_SCORE;
+        if (winner != PieceOwner::NONE) return LOSS_SCORE;
     }
 
+    int standPat = staticEval(aiPlayer, isMaximizingPlayer);
+    if (qDepth >= QUIESCENCE_PLIES) return standPat;
     if (isMaximizingPlayer) {
-        return maximizeScore(state, possibleMoves, depth, alpha, beta, aiPlayer);
+        if (standPat >= beta) return standPat;
+        alpha = std::max(alpha, standPat);
     }
     else {
-        return minimizeScore(state, possibleMoves, depth, alpha, beta, aiPlayer);
+        if (standPat <= alpha) return standPat;
+        beta = std::min(beta, standPat);
+    }
+
+    PieceOwner currentPlayer = isMaximizingPlayer ? aiPlayer : getOpponent(aiPlayer);
+    SearchArena::Mark mark = m_arena.mark();
+    Move* moves = m_arena.allocate<Move>(GameState::MAX_MOVES);
+    int moveCount = state.generateMoves(currentPlayer, moves);
+
+    int bestScore = standPat;
+    for (int i = 0; i < moveCount; i++) {
+        int forcing = qDepth == 0 ? GameState::FORCING_TACTICS : GameState::TACTIC_FOUR | GameState::TACTIC_BLOCK;
+        if (!(state.getMoveTactics(moves[i]) & forcing)) continue;
+
+        m_searchState.applyMove(moves[i], false);
+        int score = quiescence(ply + 1, qDepth + 1, alpha, beta, !isMaximizingPlayer, aiPlayer);
+        m_searchState.undoMove(moves[i]);
+        if (m_aborted) break;
+
+        if (isMaximizingPlayer ? score > bestScore : score < bestScore) {
+            bestScore = score;
+            updatePv(ply, moves[i]);
+        }
+        if (isMaximizingPlayer) alpha = std::max(alpha, score);
+        else beta = std::min(beta, score);
+        if (beta <= alpha) break;
+    }
+
+    m_arena.rewind(mark);
+    return m_aborted ? 0 : bestScore;
+}
+
+// The move at this ply followed by the line its child returned
+void MiniMax::updatePv(int ply, const Move& move)
+{
+    m_pv[ply][ply] = move;
+    for (int next = ply + 1; next < m_pvLength[ply + 1]; next++) {
+        m_pv[ply][next] = m_pv[ply + 1][next];
+    }
+    m_pvLength[ply] = std::max(m_pvLength[ply + 1], ply + 1);
+}
+
+// Depth for the child of the i-th move. Late quiet moves are searched shallower first, the caller re-searches
+// at full depth if the reduced result gets inside the window.
+int MiniMax::reducedDepth(int depth, int moveIndex, bool quiet) const
+{
+    if (!m_features.lateMoveReductions || !quiet || depth < LMR_MIN_DEPTH || moveIndex < LMR_FULL_MOVES) {
+        return depth - 1;
     }
+    return depth - 1 - (depth >= 6 && moveIndex >= 2 * LMR_FULL_MOVES + 6 ? 2 : 1);
 }
 
-int MiniMax::maximizeScore(const GameState& state,
-    const std::vector<Move>& moves,
-    int depth, int alpha, int beta,
-    PieceOwner aiPlayer)
+int MiniMax::maximizeScore(const Move* moves, int moveCount,
+    int depth, int ply, int alpha, int beta,
+    PieceOwner aiPlayer, bool pruneQuiet, int& bestIndex)
 {
     int maxScore = MIN_SCORE;
+    bool selective = pruneQuiet || (m_features.lateMoveReductions && depth >= LMR_MIN_DEPTH);
 
-    for (const Move& move : moves) {
-        GameState testState = state;
-        testState.applyMove(move, false);
+    for (int i = 0; i < moveCount; i++) {
+        bool quiet = selective && i > 0 && m_searchState.isQuietMove(moves[i]);
+        if (pruneQuiet && quiet) {
+            m_stats.futilityPrunes++;
+            continue;
+        }
 
-        int score = alphaBeta(testState, depth - 1, alpha, beta, false, aiPlayer);
+        int childDepth = reducedDepth(depth, i, quiet);
+        m_searchState.applyMove(moves[i], false);
+        int score = alphaBeta(childDepth, ply + 1, alpha, beta, false, aiPlayer);
+        if (childDepth < depth - 1) {
+            m_stats.reductions++;
+            if (score > alpha && !m_aborted) {
+                m_stats.reSearches++;
+                score = alphaBeta(depth - 1, ply + 1, alpha, beta, false, aiPlayer);
+            }
+        }
+        m_searchState.undoMove(moves[i]);
+        if (m_aborted) return 0;
 
-        maxScore = std::max(maxScore, score);
+        if (score > maxScore) {
+            maxScore = score;
+            bestIndex = i;
+            updatePv(ply, moves[i]);
+        }
         alpha = std::max(alpha, score);
 
         if (beta <= alpha) {
-            m_pruneCount++;
+            recordCutoff(moves[i], aiPlayer, depth);
+            m_stats.cutoffs++;
+            if (i == 0) m_stats.firstMoveCutoffs++;
             break;
         }
     }
@@ -326,23 +825,44 @@ int MiniMax::maximizeScore(const GameState& state,
     return maxScore;
 }
 
-int MiniMax::minimizeScore(const GameState& state,
-    const std::vector<Move>& moves,
-    int depth, int alpha, int beta,
-    PieceOwner aiPlayer)
+int MiniMax::minimizeScore(const Move* moves, int moveCount,
+    int depth, int ply, int alpha, int beta,
+    PieceOwner aiPlayer, bool pruneQuiet, int& bestIndex)
 {
     int minScore = MAX_SCORE;
+    bool selective = pruneQuiet || (m_features.lateMoveReductions && depth >= LMR_MIN_DEPTH);
 
-    for (const Move& move : moves) {
-        GameState testState = state;
-        testState.applyMove(move, false);
+    for (int i = 0; i < moveCount; i++) {
+        bool quiet = selective && i > 0 && m_searchState.isQuietMove(moves[i]);
+        if (pruneQuiet && quiet) {
+            m_stats.futilityPrunes++;
+            continue;
+        }
+
+        int childDepth = reducedDepth(depth, i, quiet);
+        m_searchState.applyMove(moves[i], false);
+        int score = alphaBeta(childDepth, ply + 1, alpha, beta, true, aiPlayer);
+        if (childDepth < depth - 1) {
+            m_stats.reductions++;
+            if (score < beta && !m_aborted) {
+                m_stats.reSearches++;
+                score = alphaBeta(depth - 1, ply + 1, alpha, beta, true, aiPlayer);
+            }
+        }
+        m_searchState.undoMove(moves[i]);
+        if (m_aborted) return 0;
 
-        int score = alphaBeta(testState, depth - 1, alpha, beta, true, aiPlayer);
-        minScore = std::min(minScore, score);
+        if (score < minScore) {
+            minScore = score;
+            bestIndex = i;
+            updatePv(ply, moves[i]);
+        }
         beta = std::min(beta, score);
 
         if (beta <= alpha) {
-            m_pruneCount++;
+            recordCutoff(moves[i], getOpponent(aiPlayer), depth);
+            m_stats.cutoffs++;
+            if (i == 0) m_stats.firstMoveCutoffs++;
             break;
         }
     }
@@ -350,6 +870,34 @@ int MiniMax::minimizeScore(const GameState& state,
     return minScore;
 }
 
+// Same squares with the other side to move is a different position
+uint64_t MiniMax::hashKey(const GameState& state, PieceOwner sideToMove) const
+{
+    return state.getBoardHash() ^ (sideToMove == PieceOwner::AI ? SIDE_TO_MOVE_KEY : 0) ^ m_hashSalt;
+}
+
+// FNV-1a over everything that changes what a search returns for a position: the side the engine plays (the
+// evaluation isn't antisymmetric, offense and defense weigh differently), weights, network and the selective
+// search switches. Engines with equal settings for the same side get equal keys and share entries.
+uint64_t MiniMax::getSettingsFingerprint() const
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ull;
+    };
+
+    const int side = (int)m_player;
+    add(&side, sizeof(side));
+    add(m_params, sizeof(EvalParams));
+    uint64_t network = m_network ? m_network->getFingerprint() : 0;
+    add(&network, sizeof(network));
+    const int features[] = { m_features.lateMoveReductions, m_features.futilityPruning, m_features.razoring,
+        m_features.threatSearch, m_features.forcedMoves, m_features.futilityMargin, m_features.razorMargin };
+    add(features, sizeof(features));
+    return hash;
+}
+
 PieceOwner MiniMax::getOpponent(PieceOwner player) const
 {
     return (player == PieceOwner::AI) ? PieceOwner::PLAYER : PieceOwner::AI;
@@ -357,11 +905,10 @@ PieceOwner MiniMax::getOpponent(PieceOwner player) const
 
 bool MiniMax::isValidPosition(int col, int row) const
 {
-    return col >= 0 && col < 5 && row >= 0 && row < 5;
+    return GameState::Geometry::contains(col, row);
 }
 
 void MiniMax::resetStatistics()
 {
-    m_nodesEvaluated = 0;
-    m_pruneCount = 0;
+    m_stats.reset();
 }
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include "NetTrainer.h"
+#include "GameState.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+
+constexpr int INPUTS = NeuralNet::INPUTS;
+constexpr int HIDDEN = NeuralNet::HIDDEN;
+using Geometry = NeuralNet::Geometry;
+
+// Keeps the int16 sums of the ten pieces plus bias inside their range once scaled by ACTIVATION_MAX
+constexpr float MAX_INPUT_WEIGHT = 20.0f;
+constexpr float MAX_OUTPUT_WEIGHT = 127.0f / NeuralNet::OUTPUT_WEIGHT_SCALE;
+
+double sigmoid(double x)
+{
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+} // namespace
+
+NetTrainer::NetTrainer(const NetTrainOptions& options)
+    : m_options(options)
+    , m_weights(WEIGHT_COUNT, 0.0f)
+    , m_gradient(WEIGHT_COUNT, 0.0f)
+    , m_momentum(WEIGHT_COUNT, 0.0f)
+    , m_velocity(WEIGHT_COUNT, 0.0f)
+    , m_step(0)
+{
+    std::mt19937_64 rng(options.seed);
+    std::uniform_real_distribution<float> small(-0.1f, 0.1f);
+    for (int i = INPUT_WEIGHTS; i < HIDDEN_BIASES; i++) m_weights[i] = small(rng);
+    for (int i = HIDDEN_BIASES; i < OUTPUT_WEIGHTS; i++) m_weights[i] = 0.25f + small(rng);
+    for (int i = OUTPUT_WEIGHTS; i < OUTPUT_BIAS; i++) m_weights[i] = small(rng) * 3.0f;
+}
+
+float NetTrainer::forward(const NetSample& sample, float* hidden) const
+{
+    for (int h = 0; h < HIDDEN; h++) hidden[h] = m_weights[HIDDEN_BIASES + h];
+    for (int i = 0; i < sample.featureCount; i++) {
+        const float* weights = &m_weights[INPUT_WEIGHTS + sample.features[i] * HIDDEN];
+        for (int h = 0; h < HIDDEN; h++) hidden[h] += weights[h];
+    }
+
+    float output = m_weights[OUTPUT_BIAS];
+    for (int h = 0; h < HIDDEN; h++) {
+        output += std::max(0.0f, std::min(1.0f, hidden[h])) * m_weights[OUTPUT_WEIGHTS + h];
+    }
+    return output;
+}
+
+void NetTrainer::trainBatch(const NetSample* const* batch, int count)
+{
+    std::fill(m_gradient.begin(), m_gradient.end(), 0.0f);
+    float hidden[HIDDEN];
+
+    for (int s = 0; s < count; s++) {
+        const NetSample& sample = *batch[s];
+        double predicted = sigmoid(forward(sample, hidden));
+
+        // d/d output of (predicted - result)^2
+        float outputGradient = (float)(2.0 * (predicted - sample.result) * predicted * (1.0 - predicted)) / count;
+        m_gradient[OUTPUT_BIAS] += outputGradient;
+
+        float hiddenGradient[HIDDEN];
+        for (int h = 0; h < HIDDEN; h++) {
+            bool active = hidden[h] > 0.0f && hidden[h] < 1.0f;
+            m_gradient[OUTPUT_WEIGHTS + h] += outputGradient * std::max(0.0f, std::min(1.0f, hidden[h]));
+            hiddenGradient[h] = active ? outputGradient * m_weights[OUTPUT_WEIGHTS + h] : 0.0f;
+            m_gradient[HIDDEN_BIASES + h] += hiddenGradient[h];
+        }
+        for (int i = 0; i < sample.featureCount; i++) {
+            float* gradient = &m_gradient[INPUT_WEIGHTS + sample.features[i] * HIDDEN];
+            for (int h = 0; h < HIDDEN; h++) gradient[h] += hiddenGradient[h];
+        }
+    }
+
+    // Adam, then clipped to what the quantized network can hold
+    const float beta1 = 0.9f, beta2 = 0.999f, epsilon = 1e-8f;
+    m_step++;
+    float correction1 = 1.0f - std::pow(beta1, (float)m_step);
+    float correction2 = 1.0f - std::pow(beta2, (float)m_step);
+    for (int i = 0; i < WEIGHT_COUNT; i++) {
+        m_momentum[i] = beta1 * m_momentum[i] + (1.0f - beta1) * m_gradient[i];
+        m_velocity[i] = beta2 * m_velocity[i] + (1.0f - beta2) * m_gradient[i] * m_gradient[i];
+        m_weights[i] -= m_options.learningRate * (m_momentum[i] / correction1)
+            / (std::sqrt(m_velocity[i] / correction2) + epsilon);
+    }
+    for (int i = INPUT_WEIGHTS; i < OUTPUT_WEIGHTS; i++) {
+        m_weights[i] = std::max(-MAX_INPUT_WEIGHT, std::min(MAX_INPUT_WEIGHT, m_weights[i]));
+    }
+    for (int i = OUTPUT_WEIGHTS; i < OUTPUT_BIAS; i++) {
+        m_weights[i] = std::max(-MAX_OUTPUT_WEIGHT, std::min(MAX_OUTPUT_WEIGHT, m_weights[i]));
+    }
+}
+
+double NetTrainer::floatLoss(const std::vector<NetSample>& samples) const
+{
+    float hidden[HIDDEN];
+    double sum = 0.0;
+    for (const NetSample& sample : samples) {
+        double error = sigmoid(forward(sample, hidden)) - sample.result;
+        sum += error * error;
+    }
+    return samples.empty() ? 0.0 : sum / samples.size();
+}
+
+double NetTrainer::quantizedLoss(const std::vector<NetSample>& samples, const NeuralNet& network, double k)
+{
+    double sum = 0.0;
+    for (const NetSample& sample : samples) {
+        double error = sigmoid(k * network.evaluateFeatures(sample.features, sample.featureCount)) - sample.result;
+        sum += error * error;
+    }
+    return samples.empty() ? 0.0 : sum / samples.size();
+}
+
+double NetTrainer::heuristicLoss(const std::vector<NetSample>& samples, double k)
+{
+    double sum = 0.0;
+    for (const NetSample& sample : samples) {
+        double error = sigmoid(k * sample.heuristic) - sample.result;
+        sum += error * error;
+    }
+    return samples.empty() ? 0.0 : sum / samples.size();
+}
+
+double NetTrainer::fitHeuristicScale(const std::vector<NetSample>& samples)
+{
+    // Same golden section search over log K as the weight tuner
+    double lo = std::log(1e-6), hi = std::log(1e-1);
+    const double ratio = 0.6180339887;
+
+    for (int i = 0; i < 40; i++) {
+        double a = hi - ratio * (hi - lo);
+        double b = lo + ratio * (hi - lo);
+        if (heuristicLoss(samples, std::exp(a)) < heuristicLoss(samples, std::exp(b))) {
+            hi = b;
+        }
+        else {
+            lo = a;
+        }
+    }
+
+    return std::exp((lo + hi) / 2.0);
+}
+
+void NetTrainer::addSymmetries(std::vector<NetSample>& samples)
+{
+    size_t originals = samples.size();
+    samples.reserve(originals * GameState::SYMMETRY_COUNT);
+
+    for (int symmetry = 1; symmetry < GameState::SYMMETRY_COUNT; symmetry++) {
+        for (size_t i = 0; i < originals; i++) {
+            NetSample copy = samples[i];
+            for (int f = 0; f < copy.featureCount; f++) {
+                int plane = copy.features[f] / Geometry::CELLS, cell = copy.features[f] % Geometry::CELLS;
+                int col, row;
+                GameState::transformSquare(symmetry, Geometry::columnOf(cell), Geometry::rowOf(cell), col, row);
+                copy.features[f] = (uint8_t)(plane * Geometry::CELLS + Geometry::cell(col, row));
+            }
+            samples.push_back(copy);
+        }
+    }
+}
+
+bool NetTrainer::train(const std::vector<NetSample>& samples, NeuralNet& network)
+{
+    if (samples.size() < 100) {
+        std::cout << "NetTrainer: " << samples.size() << " positions is too few to train on" << std::endl;
+        return false;
+    }
+
+    // Held out positions are split off before the symmetric copies so none of them leak into training
+    std::mt19937_64 rng(m_options.seed);
+    std::vector<NetSample> shuffled = samples;
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    size_t validationCount = (size_t)(shuffled.size() * m_options.validationShare);
+    std::vector<NetSample> validation(shuffled.begin(), shuffled.begin() + validationCount);
+    std::vector<NetSample> training(shuffled.begin() + validationCount, shuffled.end());
+    addSymmetries(training);
+
+    double k = fitHeuristicScale(training);
+    int outputScale = std::max(1, (int)std::lround(1.0 / k));
+    std::cout << "NetTrainer: " << training.size() << " training positions (with symmetries), "
+        << validation.size() << " held out, K = " << k << std::endl;
+    std::cout << "NetTrainer: heuristic held out loss " << heuristicLoss(validation, k) << std::endl;
+
+    std::vector<const NetSample*> order(training.size());
+    for (size_t i = 0; i < training.size(); i++) order[i] = &training[i];
+
+    float baseRate = m_options.learningRate;
+    for (int epoch = 0; epoch < m_options.epochs; epoch++) {
+        std::shuffle(order.begin(), order.end(), rng);
+        for (size_t begin = 0; begin < order.size(); begin += m_options.batchSize) {
+            int count = (int)std::min<size_t>(m_options.batchSize, order.size() - begin);
+            trainBatch(order.data() + begin, count);
+        }
+
+        // Linear decay to a tenth of the starting rate
+        m_options.learningRate = baseRate * (1.0f - 0.9f * (epoch + 1) / m_options.epochs);
+        std::cout << "NetTrainer: epoch " << epoch + 1 << "/" << m_options.epochs << "  held out loss "
+            << floatLoss(validation) << std::endl;
+    }
+    m_options.learningRate = baseRate;
+
+    network.setWeights(&m_weights[INPUT_WEIGHTS], &m_weights[HIDDEN_BIASES], &m_weights[OUTPUT_WEIGHTS],
+        m_weights[OUTPUT_BIAS], outputScale);
+    std::cout << "NetTrainer: quantized held out loss " << quantizedLoss(validation, network, k) << std::endl;
+    return true;
+}
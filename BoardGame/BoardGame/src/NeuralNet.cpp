@@ -0,0 +1,245 @@
+#include "NeuralNet.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NEURAL_NET_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// File: magic, inputs, hidden, output scale, hidden biases (int16), input weights (int16, feature major),
+// output weights (int8), output bias (int32). Little endian, as the training machine writes it.
+constexpr char NET_MAGIC[4] = { 'B', 'G', 'N', '1' };
+
+int16_t toInt16(float value)
+{
+    return (int16_t)std::max(-32767.0f, std::min(32767.0f, std::round(value)));
+}
+
+// FNV-1a
+uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+} // namespace
+
+NeuralNet::NeuralNet()
+    : m_inputWeights()
+    , m_hiddenBiases()
+    , m_outputWeights()
+    , m_outputBias(0)
+    , m_outputScale(0)
+    , m_fingerprint(0)
+    , m_loaded(false)
+{
+}
+
+NeuralNet& NeuralNet::active()
+{
+    static NeuralNet network;
+    return network;
+}
+
+const NeuralNet* NeuralNet::getActive()
+{
+    return active().isLoaded() ? &active() : nullptr;
+}
+
+bool NeuralNet::load(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    char magic[4];
+    int32_t inputs = 0, hidden = 0, outputScale = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&inputs), sizeof(inputs));
+    in.read(reinterpret_cast<char*>(&hidden), sizeof(hidden));
+    in.read(reinterpret_cast<char*>(&outputScale), sizeof(outputScale));
+    if (!in || std::memcmp(magic, NET_MAGIC, sizeof(magic)) != 0 || inputs != INPUTS || hidden != HIDDEN) {
+        return false;
+    }
+
+    int16_t hiddenBiases[HIDDEN];
+    int8_t outputWeights[HIDDEN];
+    int32_t outputBias = 0;
+    auto inputWeights = std::make_unique<int16_t[]>(INPUTS * HIDDEN);
+    in.read(reinterpret_cast<char*>(hiddenBiases), sizeof(hiddenBiases));
+    in.read(reinterpret_cast<char*>(inputWeights.get()), INPUTS * HIDDEN * sizeof(int16_t));
+    in.read(reinterpret_cast<char*>(outputWeights), sizeof(outputWeights));
+    in.read(reinterpret_cast<char*>(&outputBias), sizeof(outputBias));
+    if (!in) return false;
+
+    std::memcpy(m_inputWeights, inputWeights.get(), sizeof(m_inputWeights));
+    std::memcpy(m_hiddenBiases, hiddenBiases, sizeof(m_hiddenBiases));
+    std::copy(outputWeights, outputWeights + HIDDEN, m_outputWeights);
+    m_outputBias = outputBias;
+    m_outputScale = outputScale;
+    m_loaded = true;
+    updateFingerprint();
+    return true;
+}
+
+bool NeuralNet::save(const std::string& path) const
+{
+    std::filesystem::path outPath(path);
+    if (outPath.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(outPath.parent_path(), ec);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    int32_t header[3] = { INPUTS, HIDDEN, m_outputScale };
+    int8_t outputWeights[HIDDEN];
+    std::copy(m_outputWeights, m_outputWeights + HIDDEN, outputWeights);
+
+    out.write(NET_MAGIC, sizeof(NET_MAGIC));
+    out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(m_hiddenBiases), sizeof(m_hiddenBiases));
+    out.write(reinterpret_cast<const char*>(m_inputWeights), sizeof(m_inputWeights));
+    out.write(reinterpret_cast<const char*>(outputWeights), sizeof(outputWeights));
+    out.write(reinterpret_cast<const char*>(&m_outputBias), sizeof(m_outputBias));
+    return static_cast<bool>(out);
+}
+
+void NeuralNet::setWeights(const float* inputWeights, const float* hiddenBiases, const float* outputWeights,
+    float outputBias, int outputScale)
+{
+    for (int feature = 0; feature < INPUTS; feature++) {
+        for (int h = 0; h < HIDDEN; h++) {
+            m_inputWeights[feature][h] = toInt16(inputWeights[feature * HIDDEN + h] * ACTIVATION_MAX);
+        }
+    }
+    for (int h = 0; h < HIDDEN; h++) {
+        m_hiddenBiases[h] = toInt16(hiddenBiases[h] * ACTIVATION_MAX);
+        float weight = std::round(outputWeights[h] * OUTPUT_WEIGHT_SCALE);
+        m_outputWeights[h] = (int16_t)std::max(-127.0f, std::min(127.0f, weight));
+    }
+    m_outputBias = (int32_t)std::lround(outputBias * ACTIVATION_MAX * OUTPUT_WEIGHT_SCALE);
+    m_outputScale = outputScale;
+    m_loaded = true;
+    updateFingerprint();
+}
+
+void NeuralNet::updateFingerprint()
+{
+    uint64_t hash = hashBytes(14695981039346656037ull, m_inputWeights, sizeof(m_inputWeights));
+    hash = hashBytes(hash, m_hiddenBiases, sizeof(m_hiddenBiases));
+    hash = hashBytes(hash, m_outputWeights, sizeof(m_outputWeights));
+    hash = hashBytes(hash, &m_outputBias, sizeof(m_outputBias));
+    m_fingerprint = hashBytes(hash, &m_outputScale, sizeof(m_outputScale));
+}
+
+int NeuralNet::evaluateFeatures(const uint8_t* features, int count) const
+{
+    Accumulator accumulator;
+    int16_t* values = accumulator.values[(int)PieceOwner::PLAYER];
+    std::copy(m_hiddenBiases, m_hiddenBiases + HIDDEN, values);
+    for (int i = 0; i < count; i++) addFeature(values, features[i]);
+    return evaluate(accumulator, PieceOwner::PLAYER);
+}
+
+int NeuralNet::featureIndex(PieceOwner perspective, PieceOwner owner, PieceType type, int cell)
+{
+    return ((owner == perspective ? 0 : 3) + (int)type) * Geometry::CELLS + cell;
+}
+
+void NeuralNet::addFeature(int16_t* values, int feature) const
+{
+    const int16_t* weights = m_inputWeights[feature];
+#ifdef NEURAL_NET_SSE2
+    for (int h = 0; h < HIDDEN; h += 8) {
+        __m128i sum = _mm_add_epi16(_mm_load_si128((const __m128i*)(values + h)),
+            _mm_load_si128((const __m128i*)(weights + h)));
+        _mm_store_si128((__m128i*)(values + h), sum);
+    }
+#else
+    for (int h = 0; h < HIDDEN; h++) values[h] += weights[h];
+#endif
+}
+
+void NeuralNet::subtractFeature(int16_t* values, int feature) const
+{
+    const int16_t* weights = m_inputWeights[feature];
+#ifdef NEURAL_NET_SSE2
+    for (int h = 0; h < HIDDEN; h += 8) {
+        __m128i difference = _mm_sub_epi16(_mm_load_si128((const __m128i*)(values + h)),
+            _mm_load_si128((const __m128i*)(weights + h)));
+        _mm_store_si128((__m128i*)(values + h), difference);
+    }
+#else
+    for (int h = 0; h < HIDDEN; h++) values[h] -= weights[h];
+#endif
+}
+
+void NeuralNet::refresh(Accumulator& accumulator, Piece* const* board) const
+{
+    for (int side = 0; side < 2; side++) {
+        std::copy(m_hiddenBiases, m_hiddenBiases + HIDDEN, accumulator.values[side]);
+    }
+    for (int cell = 0; cell < Geometry::CELLS; cell++) {
+        if (board[cell]) addPiece(accumulator, board[cell], cell);
+    }
+}
+
+void NeuralNet::addPiece(Accumulator& accumulator, const Piece* piece, int cell) const
+{
+    for (PieceOwner side : { PieceOwner::PLAYER, PieceOwner::AI }) {
+        addFeature(accumulator.values[(int)side], featureIndex(side, piece->getOwner(), piece->getType(), cell));
+    }
+}
+
+void NeuralNet::removePiece(Accumulator& accumulator, const Piece* piece, int cell) const
+{
+    for (PieceOwner side : { PieceOwner::PLAYER, PieceOwner::AI }) {
+        subtractFeature(accumulator.values[(int)side], featureIndex(side, piece->getOwner(), piece->getType(), cell));
+    }
+}
+
+void NeuralNet::movePiece(Accumulator& accumulator, const Piece* piece, int fromCell, int toCell) const
+{
+    for (PieceOwner side : { PieceOwner::PLAYER, PieceOwner::AI }) {
+        int16_t* values = accumulator.values[(int)side];
+        subtractFeature(values, featureIndex(side, piece->getOwner(), piece->getType(), fromCell));
+        addFeature(values, featureIndex(side, piece->getOwner(), piece->getType(), toCell));
+    }
+}
+
+int NeuralNet::evaluate(const Accumulator& accumulator, PieceOwner player) const
+{
+    const int16_t* values = accumulator.values[(int)player];
+    int32_t sum = m_outputBias;
+
+#ifdef NEURAL_NET_SSE2
+    // Clamp to [0, ACTIVATION_MAX], then 16 bit products summed in pairs into 32 bit lanes
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ceiling = _mm_set1_epi16(ACTIVATION_MAX);
+    __m128i total = zero;
+    for (int h = 0; h < HIDDEN; h += 8) {
+        __m128i activation = _mm_min_epi16(_mm_max_epi16(_mm_load_si128((const __m128i*)(values + h)), zero), ceiling);
+        total = _mm_add_epi32(total, _mm_madd_epi16(activation, _mm_load_si128((const __m128i*)(m_outputWeights + h))));
+    }
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(1, 0, 3, 2)));
+    total = _mm_add_epi32(total, _mm_shuffle_epi32(total, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum += _mm_cvtsi128_si32(total);
+#else
+    for (int h = 0; h < HIDDEN; h++) {
+        int activation = std::max(0, std::min(ACTIVATION_MAX, (int)values[h]));
+        sum += activation * m_outputWeights[h];
+    }
+#endif
+
+    int64_t score = (int64_t)sum * m_outputScale / (ACTIVATION_MAX * OUTPUT_WEIGHT_SCALE);
+    return (int)std::max<int64_t>(-MAX_SCORE, std::min<int64_t>(MAX_SCORE, score));
+}
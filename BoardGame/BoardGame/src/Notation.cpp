@@ -0,0 +1,75 @@
+#include "Notation.h"
+#include <cctype>
+
+namespace Notation {
+
+std::string squareName(int col, int row)
+{
+    return { (char)('a' + col), (char)('1' + row) };
+}
+
+bool parseSquare(const std::string& text, int& col, int& row)
+{
+    if (text.size() != 2) return false;
+    col = std::tolower((unsigned char)text[0]) - 'a';
+    row = text[1] - '1';
+    return col >= 0 && col < 5 && row >= 0 && row < 5;
+}
+
+std::string moveName(const Move& move)
+{
+    return squareName(move.fromCol, move.fromRow) + squareName(move.toCol, move.toRow);
+}
+
+PieceType parsePieceType(char letter)
+{
+    switch (std::toupper((unsigned char)letter)) {
+    case 'F': return PieceType::FROG;
+    case 'S': return PieceType::SNAKE;
+    case 'D': return PieceType::DONKEY;
+    default: return PieceType::NONE;
+    }
+}
+
+char pieceLetter(const Piece* piece)
+{
+    if (!piece) return '.';
+    char letter = "FSD"[(int)piece->getType()];
+    return piece->getOwner() == PieceOwner::AI ? (char)std::tolower((unsigned char)letter) : letter;
+}
+
+std::string boardString(const GameState& state)
+{
+    std::string board;
+    for (int row = 0; row < 5; row++) {
+        for (int col = 0; col < 5; col++) {
+            board += pieceLetter(state.getPieceAt(col, row));
+        }
+    }
+    return board;
+}
+
+bool parseBoard(const std::string& board, const std::vector<Piece*>& pool, GameState& state,
+    bool updatePiecePosition)
+{
+    if (board.size() != 25) return false;
+
+    std::vector<bool> used(pool.size(), false);
+    for (int i = 0; i < 25; i++) {
+        if (board[i] == '.') continue;
+
+        PieceType type = parsePieceType(board[i]);
+        PieceOwner owner = std::isupper((unsigned char)board[i]) ? PieceOwner::PLAYER : PieceOwner::AI;
+        if (type == PieceType::NONE) return false;
+
+        size_t p = 0;
+        while (p < pool.size() && (used[p] || pool[p]->getType() != type || pool[p]->getOwner() != owner)) p++;
+        if (p == pool.size()) return false;
+
+        used[p] = true;
+        state.applyPlacement(i % 5, i / 5, pool[p], updatePiecePosition);
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,368 @@
+#include "OpeningBook.h"
+#include "Frog.h"
+#include "Snake.h"
+#include "Donkey.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <unordered_set>
+
+namespace {
+
+struct BookHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+constexpr char BOOK_MAGIC[4] = { 'B', 'G', 'O', 'B' };
+constexpr uint32_t BOOK_VERSION = 1;
+
+static_assert(sizeof(BookHeader) == 16, "book header layout");
+static_assert(sizeof(BookEntry) == 16, "book entry layout");
+
+constexpr int PIECES_PER_SIDE = 5;
+constexpr int WIN_SCORE = 10000;
+
+// Pieces per type for each side (Frog, Snake, Donkey)
+constexpr int PIECE_COUNTS[3] = { 1, 1, 3 };
+
+// Squares tried centre first so the search cuts off early
+constexpr int SEARCH_ORDER[25][2] = {
+    {2,2}, {1,2}, {2,1}, {3,2}, {2,3}, {1,1}, {3,1}, {1,3}, {3,3},
+    {0,2}, {2,0}, {4,2}, {2,4}, {0,1}, {1,0}, {3,0}, {4,1},
+    {0,3}, {1,4}, {3,4}, {4,3}, {0,0}, {4,0}, {0,4}, {4,4}
+};
+
+// Headless piece pool and placement search used to fill the book
+class BookBuilder
+{
+public:
+    BookBuilder(int searchDepth) : m_searchDepth(searchDepth), m_nodes(0)
+    {
+        for (int owner = 0; owner < 2; owner++) {
+            PieceOwner side = owner == 0 ? PieceOwner::PLAYER : PieceOwner::AI;
+            m_pool.push_back(std::make_unique<Frog>(side, ""));
+            m_pool.push_back(std::make_unique<Snake>(side, ""));
+            m_pool.push_back(std::make_unique<Donkey>(side, ""));
+            m_pool.push_back(std::make_unique<Donkey>(side, ""));
+            m_pool.push_back(std::make_unique<Donkey>(side, ""));
+        }
+    }
+
+    static PieceOwner sideToPlace(const GameState& state)
+    {
+        // Player always places first and turns alternate
+        return (countPlaced(state) % 2 == 0) ? PieceOwner::PLAYER : PieceOwner::AI;
+    }
+
+    static int countPlaced(const GameState& state)
+    {
+        int count = 0;
+        for (int col = 0; col < 5; col++) {
+            for (int row = 0; row < 5; row++) {
+                if (state.getPieceAt(col, row)) count++;
+            }
+        }
+        return count;
+    }
+
+    static int countPlaced(const GameState& state, PieceOwner owner, PieceType type)
+    {
+        int count = 0;
+        for (int col = 0; col < 5; col++) {
+            for (int row = 0; row < 5; row++) {
+                Piece* p = state.getPieceAt(col, row);
+                if (p && p->getOwner() == owner && p->getType() == type) count++;
+            }
+        }
+        return count;
+    }
+
+    // Next unused pool piece of a type, nullptr when that side has placed all of them
+    Piece* nextPiece(const GameState& state, PieceOwner owner, PieceType type) const
+    {
+        int used = countPlaced(state, owner, type);
+        if (used >= PIECE_COUNTS[(int)type]) return nullptr;
+
+        int first = (owner == PieceOwner::PLAYER) ? 0 : PIECES_PER_SIDE;
+        int offset = (type == PieceType::FROG) ? 0 : (type == PieceType::SNAKE ? 1 : 2);
+        return m_pool[first + offset + used].get();
+    }
+
+    // Inside the search each side places its pieces in the same order the AI uses
+    Piece* nextPieceInOrder(const GameState& state, PieceOwner owner) const
+    {
+        for (PieceType type : { PieceType::FROG, PieceType::SNAKE, PieceType::DONKEY }) {
+            Piece* p = nextPiece(state, owner, type);
+            if (p) return p;
+        }
+        return nullptr;
+    }
+
+    // Returns the best square for the piece and its score from the placing side's point of view
+    int searchRoot(const GameState& state, Piece* piece, int& bestCol, int& bestRow)
+    {
+        PieceOwner me = piece->getOwner();
+        int alpha = -WIN_SCORE * 2;
+        int beta = WIN_SCORE * 2;
+        int bestScore = -WIN_SCORE * 2;
+        std::vector<uint64_t> seen;
+
+        bestCol = -1;
+        bestRow = -1;
+
+        for (const auto& cell : SEARCH_ORDER) {
+            int col = cell[0], row = cell[1];
+            if (!state.isPositionEmpty(col, row)) continue;
+
+            GameState child = state;
+            child.applyPlacement(col, row, piece, false);
+
+            // Skip squares that are mirror images of one already searched
+            uint64_t canonical = child.getCanonicalHash();
+            if (std::find(seen.begin(), seen.end(), canonical) != seen.end()) continue;
+            seen.push_back(canonical);
+
+            int score = search(child, m_searchDepth - 1, alpha, beta, false, me);
+            if (score > bestScore) {
+                bestScore = score;
+                bestCol = col;
+                bestRow = row;
+            }
+            alpha = std::max(alpha, score);
+        }
+
+        return bestScore;
+    }
+
+    long long getNodes() const { return m_nodes; }
+
+private:
+    int search(const GameState& state, int depth, int alpha, int beta, bool isMaximizing, PieceOwner me)
+    {
+        m_nodes++;
+
+        PieceOwner winner = state.getWinner();
+        if (winner == me) return WIN_SCORE + depth;
+        if (winner != PieceOwner::NONE) return -WIN_SCORE - depth;
+
+        int placed = countPlaced(state);
+        if (depth == 0 || placed >= PIECES_PER_SIDE * 2) {
+            return state.evaluate(me);
+        }
+
+        PieceOwner mover = sideToPlace(state);
+        Piece* piece = nextPieceInOrder(state, mover);
+        if (!piece) return state.evaluate(me);
+
+        // Mirror images only repeat while the board is nearly empty
+        bool reduceSymmetry = placed <= 3;
+        std::vector<uint64_t> seen;
+
+        int best = isMaximizing ? -WIN_SCORE * 2 : WIN_SCORE * 2;
+
+        for (const auto& cell : SEARCH_ORDER) {
+            int col = cell[0], row = cell[1];
+            if (!state.isPositionEmpty(col, row)) continue;
+
+            GameState child = state;
+            child.applyPlacement(col, row, piece, false);
+
+            if (reduceSymmetry) {
+                uint64_t canonical = child.getCanonicalHash();
+                if (std::find(seen.begin(), seen.end(), canonical) != seen.end()) continue;
+                seen.push_back(canonical);
+            }
+
+            int score = search(child, depth - 1, alpha, beta, !isMaximizing, me);
+
+            if (isMaximizing) {
+                best = std::max(best, score);
+                alpha = std::max(alpha, score);
+            }
+            else {
+                best = std::min(best, score);
+                beta = std::min(beta, score);
+            }
+
+            if (beta <= alpha) break;
+        }
+
+        return best;
+    }
+
+    std::vector<std::unique_ptr<Piece>> m_pool;
+    int m_searchDepth;
+    long long m_nodes;
+};
+
+} // namespace
+
+OpeningBook::OpeningBook()
+    : m_entries(nullptr)
+    , m_count(0)
+{
+}
+
+bool OpeningBook::load(const std::string& path)
+{
+    m_entries = nullptr;
+    m_count = 0;
+
+    if (!m_file.open(path)) {
+        return false;
+    }
+
+    if (m_file.size() < sizeof(BookHeader)) {
+        m_file.close();
+        return false;
+    }
+
+    BookHeader header;
+    std::memcpy(&header, m_file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0 || header.version != BOOK_VERSION
+        || m_file.size() < sizeof(BookHeader) + header.count * sizeof(BookEntry)) {
+        std::cout << "Opening book is invalid: " << path << std::endl;
+        m_file.close();
+        return false;
+    }
+
+    m_entries = reinterpret_cast<const BookEntry*>(m_file.data() + sizeof(BookHeader));
+    m_count = header.count;
+    return true;
+}
+
+bool OpeningBook::probe(const GameState& state, const Piece* piece, int& col, int& row) const
+{
+    if (!m_entries || !piece) return false;
+
+    int symmetry = 0;
+    uint64_t key = makeKey(state.getCanonicalHash(&symmetry), piece->getType(), piece->getOwner());
+
+    const BookEntry* end = m_entries + m_count;
+    const BookEntry* it = std::lower_bound(m_entries, end, key,
+        [](const BookEntry& entry, uint64_t k) { return entry.key < k; });
+
+    if (it == end || it->key != key) return false;
+
+    // Book square is stored for the canonical board, map it back onto this board
+    GameState::transformSquare(GameState::inverseSymmetry(symmetry), it->cell / 5, it->cell % 5, col, row);
+
+    return state.isValidPlacement(col, row);
+}
+
+uint64_t OpeningBook::makeKey(uint64_t canonicalHash, PieceType type, PieceOwner owner)
+{
+    // splitmix64 of the piece id so the same board gives a different key per piece to place
+    uint64_t z = 0x9E3779B97F4A7C15ull * (uint64_t)((int)type * 2 + (owner == PieceOwner::PLAYER ? 0 : 1) + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return canonicalHash ^ (z ^ (z >> 31));
+}
+
+bool OpeningBook::build(const std::string& path, int bookPlies, int searchDepth)
+{
+    if (bookPlies < 1 || searchDepth < 1) {
+        std::cout << "Book: plies and depth must be at least 1" << std::endl;
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    BookBuilder builder(searchDepth);
+
+    std::vector<BookEntry> entries;
+    std::vector<GameState> level(1);
+    level[0].clearPositionHistory();
+
+    for (int ply = 0; ply < bookPlies && !level.empty(); ply++) {
+        std::vector<GameState> nextLevel;
+        std::unordered_set<uint64_t> nextSeen;
+
+        for (const GameState& state : level) {
+            PieceOwner side = BookBuilder::sideToPlace(state);
+
+            for (PieceType type : { PieceType::FROG, PieceType::SNAKE, PieceType::DONKEY }) {
+                Piece* piece = builder.nextPiece(state, side, type);
+                if (!piece) continue;
+
+                // Store the reply in the canonical orientation so every mirror image shares the entry
+                int symmetry = 0;
+                uint64_t canonical = state.getCanonicalHash(&symmetry);
+
+                int bestCol, bestRow;
+                int score = builder.searchRoot(state, piece, bestCol, bestRow);
+                if (bestCol >= 0) {
+                    int canonCol, canonRow;
+                    GameState::transformSquare(symmetry, bestCol, bestRow, canonCol, canonRow);
+
+                    BookEntry entry{};
+                    entry.key = makeKey(canonical, type, side);
+                    entry.score = score;
+                    entry.cell = (uint8_t)(canonCol * 5 + canonRow);
+                    entry.depth = (uint8_t)searchDepth;
+                    entries.push_back(entry);
+                }
+
+                // Expand every placement of this piece for the next level
+                if (ply + 1 >= bookPlies) continue;
+
+                for (int col = 0; col < 5; col++) {
+                    for (int row = 0; row < 5; row++) {
+                        if (!state.isPositionEmpty(col, row)) continue;
+
+                        GameState child = state;
+                        child.applyPlacement(col, row, piece, false);
+                        if (child.getWinner() != PieceOwner::NONE) continue;
+
+                        if (nextSeen.insert(child.getCanonicalHash()).second) {
+                            nextLevel.push_back(child);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::cout << "Book: ply " << ply << " searched " << level.size() << " positions, "
+            << entries.size() << " entries, " << builder.getNodes() << " nodes" << std::endl;
+
+        level.swap(nextLevel);
+    }
+
+    std::sort(entries.begin(), entries.end(),
+        [](const BookEntry& a, const BookEntry& b) { return a.key < b.key; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+        [](const BookEntry& a, const BookEntry& b) { return a.key == b.key; }), entries.end());
+
+    std::filesystem::path outPath(path);
+    if (outPath.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(outPath.parent_path(), ec);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cout << "Book: cannot write " << path << std::endl;
+        return false;
+    }
+
+    BookHeader header{};
+    std::memcpy(header.magic, BOOK_MAGIC, sizeof(BOOK_MAGIC));
+    header.version = BOOK_VERSION;
+    header.count = (uint32_t)entries.size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(BookEntry));
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Book: wrote " << entries.size() << " entries to " << path
+        << " (" << seconds << "s)" << std::endl;
+
+    return (bool)out;
+}
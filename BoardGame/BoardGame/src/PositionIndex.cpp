@@ -0,0 +1,246 @@
+#include "PositionIndex.h"
+#include <algorithm>
+
+namespace {
+
+using Geometry = GameState::Geometry;
+constexpr int CELLS = Geometry::CELLS;
+
+struct IndexTables {
+    uint8_t symmetric[GameState::SYMMETRY_COUNT][CELLS] = {}; // where each symmetry takes each cell
+    int16_t pairIndex[CELLS][CELLS] = {};  // [player frog][player snake], -1 unless both are canonical
+    uint8_t pairFrog[CELLS * CELLS] = {};
+    uint8_t pairSnake[CELLS * CELLS] = {};
+    int pairCount = 0;
+    uint64_t binomial[CELLS + 1][4] = {};  // n choose k for the donkey combinations
+};
+
+constexpr IndexTables makeTables()
+{
+    IndexTables t{};
+    for (int symmetry = 0; symmetry < GameState::SYMMETRY_COUNT; symmetry++) {
+        for (int cell = 0; cell < CELLS; cell++) {
+            int col = 0, row = 0;
+            Geometry::transformSquare(symmetry, Geometry::columnOf(cell), Geometry::rowOf(cell), col, row);
+            t.symmetric[symmetry][cell] = (uint8_t)Geometry::cell(col, row);
+        }
+    }
+
+    for (int n = 0; n <= CELLS; n++) {
+        t.binomial[n][0] = 1;
+        for (int k = 1; k < 4; k++) t.binomial[n][k] = n == 0 ? 0 : t.binomial[n - 1][k - 1] + t.binomial[n - 1][k];
+    }
+
+    // The frog goes on the smallest square of its orbit, the snake on the smallest square of its orbit under
+    // the symmetries that leave that frog square alone
+    for (int frog = 0; frog < CELLS; frog++) {
+        int smallest = frog;
+        for (int symmetry = 0; symmetry < GameState::SYMMETRY_COUNT; symmetry++) {
+            smallest = t.symmetric[symmetry][frog] < smallest ? t.symmetric[symmetry][frog] : smallest;
+        }
+
+        for (int snake = 0; snake < CELLS; snake++) {
+            t.pairIndex[frog][snake] = -1;
+            if (smallest != frog || snake == frog) continue;
+
+            bool canonical = true;
+            for (int symmetry = 0; symmetry < GameState::SYMMETRY_COUNT; symmetry++) {
+                if (t.symmetric[symmetry][frog] == frog && t.symmetric[symmetry][snake] < snake) canonical = false;
+            }
+            if (!canonical) continue;
+
+            t.pairFrog[t.pairCount] = (uint8_t)frog;
+            t.pairSnake[t.pairCount] = (uint8_t)snake;
+            t.pairIndex[frog][snake] = (int16_t)t.pairCount++;
+        }
+    }
+    return t;
+}
+
+constexpr IndexTables TABLES = makeTables();
+
+// Radices after the (frog, snake) pair: AI frog, AI snake, player donkeys, AI donkeys
+constexpr uint64_t AI_FROG_SQUARES = CELLS - 2;
+constexpr uint64_t AI_SNAKE_SQUARES = CELLS - 3;
+constexpr uint64_t PLAYER_DONKEY_SETS = TABLES.binomial[CELLS - 4][3];
+constexpr uint64_t AI_DONKEY_SETS = TABLES.binomial[CELLS - 7][3];
+constexpr uint64_t REST_SIZE = AI_FROG_SQUARES * AI_SNAKE_SQUARES * PLAYER_DONKEY_SETS * AI_DONKEY_SETS;
+
+int bitCount(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((x * 0x0101010101010101ull) >> 56);
+}
+
+// Position of a cell among the cells not in occupied
+int freeIndex(int cell, uint64_t occupied)
+{
+    return cell - bitCount(occupied & ((1ull << cell) - 1));
+}
+
+// The cells not in occupied, in order, so unranking can pick the n-th free cell directly
+int listFree(uint64_t occupied, uint8_t* cells)
+{
+    int count = 0;
+    for (int cell = 0; cell < CELLS; cell++) {
+        cells[count] = (uint8_t)cell;
+        count += (int)(~occupied >> cell & 1);
+    }
+    return count;
+}
+
+// Colex rank of three squares among the free ones
+uint64_t rankDonkeys(const uint8_t* cells, uint64_t occupied)
+{
+    int a = freeIndex(cells[0], occupied), b = freeIndex(cells[1], occupied), c = freeIndex(cells[2], occupied);
+    if (a > b) std::swap(a, b);
+    if (b > c) std::swap(b, c);
+    if (a > b) std::swap(a, b);
+    return TABLES.binomial[a][1] + TABLES.binomial[b][2] + TABLES.binomial[c][3];
+}
+
+void unrankDonkeys(uint64_t rank, uint64_t occupied, uint8_t* cells)
+{
+    uint8_t free[CELLS];
+    int n = listFree(occupied, free);
+
+    // Largest n with n choose k <= rank, for k = 3, 2, 1, each below the last
+    for (int k = 3; k >= 1; k--) {
+        n--;
+        while (TABLES.binomial[n][k] > rank) n--;
+        rank -= TABLES.binomial[n][k];
+        cells[k - 1] = free[n];
+    }
+}
+
+uint64_t rankRest(const MaterialSquares& squares, const uint8_t* symmetric, uint64_t occupied)
+{
+    int aiFrog = symmetric[squares.frog[1]];
+    uint64_t rank = (uint64_t)freeIndex(aiFrog, occupied);
+    occupied |= 1ull << aiFrog;
+
+    int aiSnake = symmetric[squares.snake[1]];
+    rank = rank * AI_SNAKE_SQUARES + (uint64_t)freeIndex(aiSnake, occupied);
+    occupied |= 1ull << aiSnake;
+
+    for (int side = 0; side < 2; side++) {
+        uint8_t donkeys[3];
+        for (int i = 0; i < 3; i++) donkeys[i] = symmetric[squares.donkeys[side][i]];
+        rank = rank * (side == 0 ? PLAYER_DONKEY_SETS : AI_DONKEY_SETS) + rankDonkeys(donkeys, occupied);
+        for (uint8_t cell : donkeys) occupied |= 1ull << cell;
+    }
+    return rank;
+}
+
+} // namespace
+
+bool MaterialSquares::fromState(const GameState& state, MaterialSquares& out)
+{
+    int frogs[2] = {}, snakes[2] = {}, donkeys[2] = {};
+
+    for (int cell = 0; cell < CELLS; cell++) {
+        Piece* piece = state.getPieceAt(Geometry::columnOf(cell), Geometry::rowOf(cell));
+        if (!piece) continue;
+
+        int side = piece->getOwner() == PieceOwner::PLAYER ? 0 : 1;
+        switch (piece->getType()) {
+        case PieceType::FROG:
+            if (frogs[side]++ == 0) out.frog[side] = (uint8_t)cell;
+            break;
+        case PieceType::SNAKE:
+            if (snakes[side]++ == 0) out.snake[side] = (uint8_t)cell;
+            break;
+        case PieceType::DONKEY:
+            if (donkeys[side] < 3) out.donkeys[side][donkeys[side]] = (uint8_t)cell;
+            donkeys[side]++;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    for (int side = 0; side < 2; side++) {
+        if (frogs[side] != 1 || snakes[side] != 1 || donkeys[side] != 3) return false;
+    }
+    return true;
+}
+
+void MaterialSquares::applyTo(GameState& state, Piece* const* pool) const
+{
+    for (int side = 0; side < 2; side++) {
+        Piece* const* pieces = pool + side * 5;
+        const uint8_t cells[5] = { frog[side], snake[side], donkeys[side][0], donkeys[side][1], donkeys[side][2] };
+        for (int i = 0; i < 5; i++) {
+            state.applyPlacement(Geometry::columnOf(cells[i]), Geometry::rowOf(cells[i]), pieces[i], false);
+        }
+    }
+    state.setPhase(GamePhase::MOVEMENT);
+}
+
+uint64_t PositionIndex::size()
+{
+    return (uint64_t)TABLES.pairCount * REST_SIZE;
+}
+
+uint64_t PositionIndex::rank(const MaterialSquares& squares)
+{
+    // Every symmetry that puts the frog and snake on their canonical squares gives a valid index, the
+    // smallest is the rank. Usually only one does.
+    uint64_t best = ~0ull;
+    for (int symmetry = 0; symmetry < GameState::SYMMETRY_COUNT; symmetry++) {
+        const uint8_t* symmetric = TABLES.symmetric[symmetry];
+        int frog = symmetric[squares.frog[0]], snake = symmetric[squares.snake[0]];
+        int pair = TABLES.pairIndex[frog][snake];
+        if (pair < 0) continue;
+
+        uint64_t occupied = (1ull << frog) | (1ull << snake);
+        best = std::min(best, (uint64_t)pair * REST_SIZE + rankRest(squares, symmetric, occupied));
+    }
+    return best;
+}
+
+bool PositionIndex::unrank(uint64_t index, MaterialSquares& squares)
+{
+    // Past the last pair the tables are zero filled and would decode to nonsense
+    if (index >= size()) return false;
+
+    int pair = (int)(index / REST_SIZE);
+    uint64_t rest = index % REST_SIZE;
+    uint64_t aiDonkeys = rest % AI_DONKEY_SETS;
+    rest /= AI_DONKEY_SETS;
+    uint64_t playerDonkeys = rest % PLAYER_DONKEY_SETS;
+    rest /= PLAYER_DONKEY_SETS;
+
+    squares.frog[0] = TABLES.pairFrog[pair];
+    squares.snake[0] = TABLES.pairSnake[pair];
+    uint64_t occupied = (1ull << squares.frog[0]) | (1ull << squares.snake[0]);
+
+    uint8_t free[CELLS];
+    listFree(occupied, free);
+    squares.frog[1] = free[rest / AI_SNAKE_SQUARES];
+    occupied |= 1ull << squares.frog[1];
+    listFree(occupied, free);
+    squares.snake[1] = free[rest % AI_SNAKE_SQUARES];
+    occupied |= 1ull << squares.snake[1];
+
+    unrankDonkeys(playerDonkeys, occupied, squares.donkeys[0]);
+    for (uint8_t cell : squares.donkeys[0]) occupied |= 1ull << cell;
+    unrankDonkeys(aiDonkeys, occupied, squares.donkeys[1]);
+    return true;
+}
+
+bool PositionIndex::rank(const GameState& state, uint64_t& index)
+{
+    MaterialSquares squares;
+    if (!MaterialSquares::fromState(state, squares)) return false;
+    index = rank(squares);
+    return true;
+}
+
+PackedResultTable::PackedResultTable(uint64_t size)
+    : m_words((size_t)((size + 31) / 32), 0)
+    , m_size(size)
+{
+}
@@ -0,0 +1,72 @@
+#include "Profiler.h"
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+Profiler& Profiler::get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+    : m_active(false)
+    , m_origin(std::chrono::steady_clock::now())
+{
+}
+
+Profiler::~Profiler()
+{
+    end();
+}
+
+void Profiler::begin(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_path = path;
+    m_events.clear();
+    m_events.reserve(1 << 16);
+    m_origin = std::chrono::steady_clock::now();
+    m_active.store(true, std::memory_order_release);
+}
+
+void Profiler::end()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_active.load(std::memory_order_relaxed)) return;
+    m_active.store(false, std::memory_order_relaxed);
+
+    std::ofstream file(m_path);
+    if (!file) {
+        std::cout << "Profiler: could not write " << m_path << std::endl;
+        return;
+    }
+
+    // Complete ("X") events, timestamps in microseconds
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (size_t i = 0; i < m_events.size(); i++) {
+        const TraceEvent& event = m_events[i];
+        file << "{\"name\":\"" << event.name << "\",\"cat\":\"boardgame\",\"ph\":\"X\",\"ts\":" << event.start
+            << ",\"dur\":" << event.duration << ",\"pid\":1,\"tid\":" << event.threadId << "}"
+            << (i + 1 < m_events.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+
+    std::cout << "Profiler: wrote " << m_events.size() << " events to " << m_path << std::endl;
+    m_events.clear();
+}
+
+void Profiler::addEvent(const char* name, int64_t startMicros, int64_t durationMicros)
+{
+    uint32_t threadId = (uint32_t)std::hash<std::thread::id>()(std::this_thread::get_id());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_active.load(std::memory_order_relaxed)) return;
+    m_events.push_back({ name, threadId, startMicros, durationMicros });
+}
+
+int64_t Profiler::nowMicros() const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_origin).count();
+}
@@ -0,0 +1,31 @@
+#include "SearchArena.h"
+#include <algorithm>
+
+SearchArena::SearchArena(size_t blockSize)
+    : m_blockSize(blockSize)
+    , m_block(0)
+    , m_offset(0)
+    , m_highWater(0)
+{
+    // First block up front so the first search doesnt allocate either
+    m_blocks.push_back(std::make_unique<unsigned char[]>(m_blockSize));
+}
+
+void* SearchArena::allocateBytes(size_t bytes, size_t alignment)
+{
+    if (bytes > m_blockSize) throw std::bad_alloc(); // bigger than any scratch buffer the search asks for
+
+    size_t offset = (m_offset + alignment - 1) & ~(alignment - 1);
+    if (offset + bytes > m_blockSize) {
+        // Move on to the next block, only allocating the first time the search gets this deep
+        m_block++;
+        offset = 0;
+        if (m_block == m_blocks.size()) {
+            m_blocks.push_back(std::make_unique<unsigned char[]>(m_blockSize));
+        }
+    }
+
+    m_offset = offset + bytes;
+    m_highWater = std::max(m_highWater, m_block * m_blockSize + m_offset);
+    return m_blocks[m_block].get() + offset;
+}
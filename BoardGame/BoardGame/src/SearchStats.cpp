@@ -0,0 +1,116 @@
+#include "SearchStats.h"
+#include <algorithm>
+#include <cmath>
+
+void SearchStats::reset()
+{
+    // Keeps the iteration list's storage so a warmed up search doesnt allocate for it
+    std::vector<IterationStats> keep;
+    keep.swap(iterations);
+    *this = SearchStats();
+    keep.clear();
+    iterations.swap(keep);
+}
+
+void SearchStats::add(const SearchStats& other)
+{
+    depth = std::max(depth, other.depth);
+    rootMoves += other.rootMoves;
+    nodes += other.nodes;
+    for (int ply = 0; ply < MAX_PLY; ply++) {
+        nodesPerPly[ply] += other.nodesPerPly[ply];
+    }
+    cutoffs += other.cutoffs;
+    firstMoveCutoffs += other.firstMoveCutoffs;
+    ttProbes += other.ttProbes;
+    ttHits += other.ttHits;
+    reductions += other.reductions;
+    reSearches += other.reSearches;
+    futilityPrunes += other.futilityPrunes;
+    razorCuts += other.razorCuts;
+    quiescenceNodes += other.quiescenceNodes;
+    forcedNodes += other.forcedNodes;
+    forcedMovesSkipped += other.forcedMovesSkipped;
+    micros += other.micros;
+    allocations += other.allocations;
+    allocatedBytes += other.allocatedBytes;
+}
+
+double SearchStats::effectiveBranchingFactor() const
+{
+    // With iterations, growth from one depth to the next. Otherwise the depth-th root of the tree size
+    if (iterations.size() >= 2) {
+        const IterationStats& last = iterations.back();
+        const IterationStats& previous = iterations[iterations.size() - 2];
+        if (previous.nodes > 0) return (double)last.nodes / (double)previous.nodes;
+    }
+    if (depth <= 0 || nodes == 0) return 0.0;
+    return std::pow((double)nodes, 1.0 / depth);
+}
+
+double SearchStats::firstMoveCutoffRate() const
+{
+    return cutoffs > 0 ? (double)firstMoveCutoffs / (double)cutoffs : 0.0;
+}
+
+double SearchStats::ttHitRate() const
+{
+    return ttProbes > 0 ? (double)ttHits / (double)ttProbes : 0.0;
+}
+
+double SearchStats::nodesPerSecond() const
+{
+    return micros > 0 ? (double)nodes * 1e6 / (double)micros : 0.0;
+}
+
+double SearchStats::allocationsPerNode() const
+{
+    return nodes > 0 ? (double)allocations / (double)nodes : 0.0;
+}
+
+void SearchStats::writeJson(std::ostream& out) const
+{
+    out << "{\"depth\":" << depth << ",\"score\":" << score << ",\"rootMoves\":" << rootMoves
+        << ",\"nodes\":" << nodes << ",\"micros\":" << micros
+        << ",\"nps\":" << (uint64_t)nodesPerSecond()
+        << ",\"ebf\":" << effectiveBranchingFactor()
+        << ",\"cutoffs\":" << cutoffs << ",\"firstMoveCutoffRate\":" << firstMoveCutoffRate()
+        << ",\"ttProbes\":" << ttProbes << ",\"ttHits\":" << ttHits << ",\"ttHitRate\":" << ttHitRate()
+        << ",\"reductions\":" << reductions << ",\"reSearches\":" << reSearches
+        << ",\"futilityPrunes\":" << futilityPrunes << ",\"razorCuts\":" << razorCuts
+        << ",\"quiescenceNodes\":" << quiescenceNodes
+        << ",\"forcedNodes\":" << forcedNodes << ",\"forcedMovesSkipped\":" << forcedMovesSkipped
+        << ",\"allocations\":" << allocations << ",\"allocatedBytes\":" << allocatedBytes;
+
+    int lastPly = MAX_PLY - 1;
+    while (lastPly > 0 && nodesPerPly[lastPly] == 0) lastPly--;
+    out << ",\"nodesPerPly\":[";
+    for (int ply = 0; ply <= lastPly; ply++) {
+        out << (ply ? "," : "") << nodesPerPly[ply];
+    }
+
+    out << "],\"iterations\":[";
+    for (size_t i = 0; i < iterations.size(); i++) {
+        const IterationStats& it = iterations[i];
+        out << (i ? "," : "") << "{\"depth\":" << it.depth << ",\"score\":" << it.score
+            << ",\"nodes\":" << it.nodes << ",\"micros\":" << it.micros << "}";
+    }
+    out << "]}";
+}
+
+void SearchStats::writeCsvHeader(std::ostream& out)
+{
+    out << "depth,score,root_moves,nodes,micros,nps,ebf,cutoffs,first_move_cutoff_rate,"
+        "tt_probes,tt_hits,tt_hit_rate,reductions,re_searches,futility_prunes,razor_cuts,"
+        "quiescence_nodes,forced_nodes,forced_moves_skipped,allocations,allocated_bytes";
+}
+
+void SearchStats::writeCsvRow(std::ostream& out) const
+{
+    out << depth << ',' << score << ',' << rootMoves << ',' << nodes << ',' << micros << ','
+        << (uint64_t)nodesPerSecond() << ',' << effectiveBranchingFactor() << ',' << cutoffs << ','
+        << firstMoveCutoffRate() << ',' << ttProbes << ',' << ttHits << ',' << ttHitRate()
+        << ',' << reductions << ',' << reSearches << ',' << futilityPrunes << ',' << razorCuts
+        << ',' << quiescenceNodes << ',' << forcedNodes << ',' << forcedMovesSkipped
+        << ',' << allocations << ',' << allocatedBytes;
+}
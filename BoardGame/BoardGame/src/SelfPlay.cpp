@@ -0,0 +1,187 @@
+#include "SelfPlay.h"
+#include "Frog.h"
+#include "Snake.h"
+#include "Donkey.h"
+#include <chrono>
+
+SelfPlay::SelfPlay()
+    : m_lastGamePlies(0)
+    , m_recordSamples(false)
+    , m_keepSearchStats(false)
+{
+    // Headless pieces, no textures needed
+    for (PieceOwner owner : { PieceOwner::PLAYER, PieceOwner::AI }) {
+        m_pieces.push_back(std::make_unique<Frog>(owner, ""));
+        m_pieces.push_back(std::make_unique<Snake>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+    }
+
+    for (size_t i = 0; i < 5; i++) {
+        m_playerPieces.push_back(m_pieces[i].get());
+        m_aiPieces.push_back(m_pieces[i + 5].get());
+    }
+}
+
+GameResult SelfPlay::playGame(const EngineConfig& playerConfig, const EngineConfig& aiConfig,
+    uint64_t openingSeed, const SelfPlayOptions& options)
+{
+    GameState state;
+    state.clearPositionHistory();
+
+    MiniMax playerEngine(PieceOwner::PLAYER);
+    MiniMax aiEngine(PieceOwner::AI);
+    playerEngine.setVerbose(false);
+    aiEngine.setVerbose(false);
+    playerEngine.setEvalParams(&playerConfig.params);
+    aiEngine.setEvalParams(&aiConfig.params);
+    playerEngine.setSearchFeatures(playerConfig.features);
+    aiEngine.setSearchFeatures(aiConfig.features);
+    playerEngine.setNetwork(playerConfig.network);
+    aiEngine.setNetwork(aiConfig.network);
+
+    std::mt19937_64 rng(openingSeed);
+    m_lastGamePlies = 0;
+    m_samples.clear();
+    m_record.clear();
+    m_searchStats.clear();
+
+    for (auto& piece : m_pieces) {
+        piece->setGridPosition(-1, -1);
+    }
+
+    // Placement phase
+    for (int placement = 0; placement < 10; placement++) {
+        PieceOwner owner = (placement % 2 == 0) ? PieceOwner::PLAYER : PieceOwner::AI;
+        MiniMax& engine = (owner == PieceOwner::PLAYER) ? playerEngine : aiEngine;
+
+        bool randomPlacement = placement < options.randomPlacements || placement == options.exploratoryPlacement;
+        placePiece(state, engine, owner, placement / 2, randomPlacement, rng);
+        m_lastGamePlies++;
+
+        PieceOwner winner = state.getWinner();
+        if (winner != PieceOwner::NONE) return finish(winner == PieceOwner::PLAYER ? GameResult::PLAYER_WIN : GameResult::AI_WIN);
+    }
+
+    state.setPhase(GamePhase::MOVEMENT);
+
+    // Movement phase
+    PieceOwner turn = PieceOwner::PLAYER;
+    int passes = 0;
+
+    for (int ply = 0; ply < options.maxPlies; ply++) {
+        bool isPlayer = (turn == PieceOwner::PLAYER);
+        MiniMax& engine = isPlayer ? playerEngine : aiEngine;
+        const EngineConfig& config = isPlayer ? playerConfig : aiConfig;
+
+        auto start = std::chrono::steady_clock::now();
+        SearchLimits limits;
+        limits.depth = config.depth;
+        limits.nodes = config.nodes;
+        Move move = engine.search(state, limits);
+        recordStats(engine, engine.getSearchStats().depth, start);
+        if (m_keepSearchStats) m_searchStats.push_back(engine.getSearchStats());
+
+        if (move.piece) {
+            m_record.addMove(move);
+            state.applyMove(move);
+            state.recordPosition();
+            passes = 0;
+
+            PieceOwner winner = state.getWinner();
+            if (winner != PieceOwner::NONE) return finish(winner == PieceOwner::PLAYER ? GameResult::PLAYER_WIN : GameResult::AI_WIN);
+
+            if (m_recordSamples) {
+                m_samples.emplace_back();
+                fillSample(state, isPlayer ? PieceOwner::AI : PieceOwner::PLAYER, m_samples.back());
+            }
+
+            // Same position a third time, nobody is making progress
+            if (state.getPositionRepetitionCount(state.getBoardHash()) >= 3) return finish(GameResult::DRAW);
+        }
+        else {
+            m_record.addPass();
+            if (++passes >= 2) return finish(GameResult::DRAW); // neither side can move
+        }
+
+        m_lastGamePlies++;
+        turn = isPlayer ? PieceOwner::AI : PieceOwner::PLAYER;
+    }
+
+    return finish(GameResult::DRAW);
+}
+
+GameResult SelfPlay::finish(GameResult result)
+{
+    m_record.result = result;
+    return result;
+}
+
+void SelfPlay::recordStats(const MiniMax& engine, int depth, std::chrono::steady_clock::time_point start)
+{
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    PlyStats stats;
+    stats.depth = (uint8_t)depth;
+    stats.score = engine.getLastScore();
+    stats.nodes = (uint32_t)engine.getNodesEvaluated();
+    stats.timeMicros = (uint32_t)micros;
+    m_record.stats.push_back(stats);
+}
+
+bool SelfPlay::placePiece(GameState& state, MiniMax& engine, PieceOwner owner, int placed, bool randomPlacement,
+    std::mt19937_64& rng)
+{
+    Piece* piece = (owner == PieceOwner::PLAYER) ? m_playerPieces[placed] : m_aiPieces[placed];
+
+    auto start = std::chrono::steady_clock::now();
+    std::pair<int, int> placement;
+    if (randomPlacement) {
+        auto placements = state.getLegalPlacements();
+        if (placements.empty()) return false;
+        placement = placements[rng() % placements.size()];
+    }
+    else {
+        placement = engine.findBestPlacement(state, piece);
+    }
+
+    if (placement.first < 0 || placement.second < 0) return false;
+
+    if (randomPlacement) {
+        m_record.stats.emplace_back(); // no search behind a random placement
+    }
+    else {
+        recordStats(engine, 1, start);
+    }
+    m_record.addPlacement(placement.first, placement.second, piece->getType());
+
+    if (m_recordSamples) {
+        m_samples.emplace_back();
+        PositionSample& sample = m_samples.back();
+        fillSample(state, owner, sample);
+        sample.placeCol = (int8_t)placement.first;
+        sample.placeRow = (int8_t)placement.second;
+        sample.placeType = piece->getType();
+        sample.randomChoice = randomPlacement;
+    }
+
+    state.applyPlacement(placement.first, placement.second, piece);
+    return true;
+}
+
+void SelfPlay::fillSample(const GameState& state, PieceOwner sideToMove, PositionSample& sample)
+{
+    for (int col = 0; col < 5; col++) {
+        for (int row = 0; row < 5; row++) {
+            Piece* p = state.getPieceAt(col, row);
+            if (!p) {
+                sample.board[col][row] = 0;
+            }
+            else {
+                sample.board[col][row] = (int8_t)(1 + (int)p->getType() + (p->getOwner() == PieceOwner::AI ? 3 : 0));
+            }
+        }
+    }
+    sample.sideToMove = sideToMove;
+}
@@ -0,0 +1,222 @@
+#include "SharedMemory.h"
+#include <cstdint>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedMemory::SharedMemory()
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef _WIN32
+    , m_fileHandle(nullptr)
+    , m_mappingHandle(nullptr)
+#else
+    , m_fd(-1)
+#endif
+{
+}
+
+SharedMemory::~SharedMemory()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+namespace {
+
+// Maps all of mapping read/write, size 0 for the whole object
+unsigned char* mapView(HANDLE mapping, size_t size)
+{
+    return static_cast<unsigned char*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+}
+
+} // namespace
+
+bool SharedMemory::openNamed(const std::string& name, size_t size, bool& created)
+{
+    close();
+
+    uint64_t size64 = size;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+        (DWORD)(size64 >> 32), (DWORD)size64, name.c_str());
+    if (!mapping) return false;
+    created = GetLastError() != ERROR_ALREADY_EXISTS;
+
+    unsigned char* view = mapView(mapping, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (!view || VirtualQuery(view, &info, sizeof(info)) == 0) {
+        if (view) UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        return false;
+    }
+
+    m_mappingHandle = mapping;
+    m_data = view;
+    m_size = created ? size : static_cast<size_t>(info.RegionSize); // an existing one rounds up to a page
+    return true;
+}
+
+bool SharedMemory::openFile(const std::string& path, size_t size, bool& created)
+{
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+        nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    // Mapping an empty file at the requested size grows it, zero filled
+    created = fileSize.QuadPart == 0;
+    uint64_t size64 = created ? size : static_cast<uint64_t>(fileSize.QuadPart);
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, (DWORD)(size64 >> 32), (DWORD)size64, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    unsigned char* view = mapView(mapping, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_data = view;
+    m_size = static_cast<size_t>(size64);
+    return true;
+}
+
+void SharedMemory::close()
+{
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mappingHandle) CloseHandle(m_mappingHandle);
+    if (m_fileHandle) CloseHandle(m_fileHandle);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_fileHandle = nullptr;
+    m_mappingHandle = nullptr;
+}
+
+bool SharedMemory::removeNamed(const std::string&)
+{
+    // Named mappings go away with the last handle to them, one still open cannot be deleted
+    return false;
+}
+
+#else
+
+namespace {
+
+// The creator sizes the object right after creating it, another process can open it in between
+bool waitForSize(int fd, size_t& size)
+{
+    for (int attempt = 0; attempt < 200; attempt++) {
+        struct stat info;
+        if (fstat(fd, &info) != 0) return false;
+        if (info.st_size > 0) {
+            size = static_cast<size_t>(info.st_size);
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+// shm_open wants one leading slash and no others
+std::string objectName(const std::string& name)
+{
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+} // namespace
+
+bool SharedMemory::openNamed(const std::string& name, size_t size, bool& created)
+{
+    close();
+
+    std::string object = objectName(name);
+    int fd = shm_open(object.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    created = fd >= 0;
+    if (!created && errno == EEXIST) fd = shm_open(object.c_str(), O_RDWR, 0644);
+    if (fd < 0) return false;
+
+    if (created ? ftruncate(fd, static_cast<off_t>(size)) != 0 : !waitForSize(fd, size)) {
+        if (created) shm_unlink(object.c_str());
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_data = static_cast<unsigned char*>(view);
+    m_size = size;
+    return true;
+}
+
+bool SharedMemory::openFile(const std::string& path, size_t size, bool& created)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    created = fd >= 0;
+    if (!created && errno == EEXIST) fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) return false;
+
+    if (created ? ftruncate(fd, static_cast<off_t>(size)) != 0 : !waitForSize(fd, size)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_data = static_cast<unsigned char*>(view);
+    m_size = size;
+    return true;
+}
+
+void SharedMemory::close()
+{
+    if (m_data) munmap(m_data, m_size);
+    if (m_fd >= 0) ::close(m_fd);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_fd = -1;
+}
+
+bool SharedMemory::removeNamed(const std::string& name)
+{
+    return shm_unlink(objectName(name).c_str()) == 0;
+}
+
+#endif
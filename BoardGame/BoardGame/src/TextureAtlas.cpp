@@ -0,0 +1,113 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <iostream>
+
+TextureAtlas::TextureAtlas()
+    : m_built(false)
+{
+}
+
+int TextureAtlas::add(const std::string& path)
+{
+    auto it = m_pathToRegion.find(path);
+    if (it != m_pathToRegion.end())
+    {
+        return it->second;
+    }
+
+    if (m_built) return -1;
+
+    int region = (int)m_paths.size();
+    m_paths.push_back(path);
+    m_images.emplace_back();
+    m_loaded.push_back(0);
+    m_regions.emplace_back();
+    m_pathToRegion[path] = region;
+    return region;
+}
+
+bool TextureAtlas::loadImage(size_t image)
+{
+    if (!m_images[image].loadFromFile(m_paths[image]))
+    {
+        return false;
+    }
+    m_loaded[image] = 1;
+    return true;
+}
+
+bool TextureAtlas::build()
+{
+    if (m_built || m_images.empty()) return false;
+
+    // Shelf packing: left to right, new row when the current one is full
+    unsigned x = 0, y = 0, rowHeight = 0, width = 0;
+    for (size_t i = 0; i < m_images.size(); i++)
+    {
+        if (!m_loaded[i]) continue;
+
+        sf::Vector2u size = m_images[i].getSize();
+        if (x > 0 && x + size.x > MAX_WIDTH)
+        {
+            x = 0;
+            y += rowHeight + PADDING;
+            rowHeight = 0;
+        }
+        m_regions[i] = sf::IntRect({ (int)x, (int)y }, { (int)size.x, (int)size.y });
+        x += size.x + PADDING;
+        rowHeight = std::max(rowHeight, size.y);
+        width = std::max(width, x);
+    }
+
+    sf::Image packed({ std::max(width, 1u), y + std::max(rowHeight, 1u) }, sf::Color::Transparent);
+    for (size_t i = 0; i < m_images.size(); i++)
+    {
+        if (m_loaded[i] && !packed.copy(m_images[i], { (unsigned)m_regions[i].position.x, (unsigned)m_regions[i].position.y }))
+        {
+            std::cout << "Failed to pack piece atlas" << std::endl;
+            return false;
+        }
+    }
+
+    if (!m_texture.loadFromImage(packed))
+    {
+        std::cout << "Failed to create piece atlas" << std::endl;
+        return false;
+    }
+    m_texture.setSmooth(true);
+
+    std::cout << "Piece atlas: " << m_images.size() << " images packed into " << packed.getSize().x << "x"
+        << packed.getSize().y << std::endl;
+
+    m_images.clear();
+    m_images.shrink_to_fit();
+    m_built = true;
+    return true;
+}
+
+void TextureAtlas::appendQuad(sf::VertexArray& batch, int region, sf::Vector2f center, float fitSize) const
+{
+    const sf::IntRect& rect = m_regions[region];
+    if (rect.size.x <= 0 || rect.size.y <= 0) return; // image didnt load
+    float scale = std::min(fitSize / rect.size.x, fitSize / rect.size.y);
+    sf::Vector2f half(rect.size.x * scale / 2.0f, rect.size.y * scale / 2.0f);
+
+    float left = (float)rect.position.x;
+    float top = (float)rect.position.y;
+    float right = left + rect.size.x;
+    float bottom = top + rect.size.y;
+
+    const sf::Vertex corners[4] = {
+        { { center.x - half.x, center.y - half.y }, sf::Color::White, { left, top } },
+        { { center.x + half.x, center.y - half.y }, sf::Color::White, { right, top } },
+        { { center.x + half.x, center.y + half.y }, sf::Color::White, { right, bottom } },
+        { { center.x - half.x, center.y + half.y }, sf::Color::White, { left, bottom } }
+    };
+
+    batch.append(corners[0]);
+    batch.append(corners[1]);
+    batch.append(corners[2]);
+    batch.append(corners[0]);
+    batch.append(corners[2]);
+    batch.append(corners[3]);
+}
@@ -0,0 +1,262 @@
+#include "Tournament.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+double TournamentStats::score() const
+{
+    int n = games();
+    return n > 0 ? (wins + 0.5 * draws) / n : 0.5;
+}
+
+double TournamentStats::elo() const
+{
+    return Tournament::scoreToElo(score());
+}
+
+double TournamentStats::eloError() const
+{
+    int n = games();
+    if (n < 2) return 0.0;
+
+    double s = score();
+    double variance = (wins * std::pow(1.0 - s, 2) + draws * std::pow(0.5 - s, 2) + losses * std::pow(0.0 - s, 2)) / n;
+    double margin = 1.96 * std::sqrt(variance / n);
+
+    return (Tournament::scoreToElo(s + margin) - Tournament::scoreToElo(s - margin)) / 2.0;
+}
+
+double TournamentStats::llr(double elo0, double elo1) const
+{
+    int n = games();
+    if (n < 2) return 0.0;
+
+    // Normal approximation of the trinomial likelihood ratio, as used by fishtest
+    double s = score();
+    double variance = (wins * std::pow(1.0 - s, 2) + draws * std::pow(0.5 - s, 2) + losses * std::pow(0.0 - s, 2)) / n;
+    if (variance <= 0.0) return 0.0;
+
+    double s0 = Tournament::eloToScore(elo0);
+    double s1 = Tournament::eloToScore(elo1);
+
+    return n * (s1 - s0) * (2.0 * s - s0 - s1) / (2.0 * variance);
+}
+
+double SprtOptions::lowerBound() const
+{
+    return std::log(beta / (1.0 - alpha));
+}
+
+double SprtOptions::upperBound() const
+{
+    return std::log((1.0 - beta) / alpha);
+}
+
+Tournament::Tournament(const TournamentOptions& options)
+    : m_options(options)
+    , m_nextGame(0)
+    , m_stop(false)
+    , m_sprtResult(SprtResult::INCONCLUSIVE)
+{
+}
+
+double Tournament::scoreToElo(double score)
+{
+    // Clamp so a clean sweep doesnt give infinity
+    score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+double Tournament::eloToScore(double elo)
+{
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+TournamentStats Tournament::run()
+{
+    m_stats = TournamentStats();
+    m_nextGame = 0;
+    m_stop = false;
+    m_sprtResult = SprtResult::INCONCLUSIVE;
+
+    int threads = m_options.threads > 0 ? m_options.threads : (int)std::thread::hardware_concurrency();
+    threads = std::max(1, std::min(threads, m_options.games));
+
+    auto describe = [](const EngineConfig& engine) {
+        std::string limits = engine.name + " (depth " + std::to_string(engine.depth);
+        if (engine.nodes > 0) limits += ", " + std::to_string(engine.nodes) + " nodes";
+        if (engine.network) limits += ", network";
+        return limits + ")";
+    };
+    std::cout << "Tournament: " << describe(m_options.engineA) << " vs " << describe(m_options.engineB) << ", "
+        << m_options.games << " games on " << threads << " threads" << std::endl;
+
+    if (m_options.sprt.enabled) {
+        std::cout << "SPRT: elo0 " << m_options.sprt.elo0 << ", elo1 " << m_options.sprt.elo1
+            << ", alpha " << m_options.sprt.alpha << ", beta " << m_options.sprt.beta
+            << ", LLR bounds [" << m_options.sprt.lowerBound() << ", " << m_options.sprt.upperBound() << "]" << std::endl;
+    }
+
+    if (!m_options.recordPath.empty()) {
+        if (m_recordWriter.open(m_options.recordPath)) {
+            std::cout << "Recording games to " << m_options.recordPath << std::endl;
+        }
+        else {
+            std::cerr << "Failed to open record file: " << m_options.recordPath << std::endl;
+        }
+    }
+
+    m_searchTotals[0].reset();
+    m_searchTotals[1].reset();
+    if (!m_options.searchStatsPath.empty()) {
+        m_searchStatsFile.open(m_options.searchStatsPath);
+        if (m_searchStatsFile) {
+            m_searchStatsFile << "game,engine,ply,";
+            SearchStats::writeCsvHeader(m_searchStatsFile);
+            m_searchStatsFile << "\n";
+        }
+        else {
+            std::cerr << "Failed to open search stats file: " << m_options.searchStatsPath << std::endl;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back(&Tournament::worker, this);
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printStats(m_stats, seconds);
+
+    if (m_recordWriter.isOpen()) {
+        std::cout << "Recorded " << m_recordWriter.getGamesWritten() << " games" << std::endl;
+        m_recordWriter.close();
+    }
+
+    if (m_searchStatsFile.is_open()) {
+        m_searchStatsFile.close();
+        for (int engine = 0; engine < 2; engine++) {
+            const SearchStats& totals = m_searchTotals[engine];
+            std::cout << (engine == 0 ? m_options.engineA.name : m_options.engineB.name) << ": "
+                << totals.nodes << " nodes, " << (uint64_t)totals.nodesPerSecond() << " nps, first move cutoffs "
+                << totals.firstMoveCutoffRate() * 100.0 << "%, TT hits " << totals.ttHitRate() * 100.0 << "%" << std::endl;
+        }
+    }
+
+    if (m_options.sprt.enabled) {
+        double llr = m_stats.llr(m_options.sprt.elo0, m_options.sprt.elo1);
+        std::cout << "SPRT: LLR " << llr << " -> "
+            << (m_sprtResult == SprtResult::H1_ACCEPTED ? "H1 accepted (change is better)"
+                : m_sprtResult == SprtResult::H0_ACCEPTED ? "H0 accepted (change is not better)"
+                : "inconclusive, game limit reached") << std::endl;
+    }
+
+    return m_stats;
+}
+
+void Tournament::worker()
+{
+    SelfPlay selfPlay;
+    selfPlay.setKeepSearchStats(m_searchStatsFile.is_open());
+
+    while (!m_stop) {
+        int game = m_nextGame++;
+        if (game >= m_options.games) break;
+
+        // Each opening is played twice with A on both sides
+        uint64_t openingSeed = m_options.seed * 1000003ull + (uint64_t)(game / 2);
+        bool aIsPlayer = (game % 2 == 0);
+
+        const EngineConfig& playerConfig = aIsPlayer ? m_options.engineA : m_options.engineB;
+        const EngineConfig& aiConfig = aIsPlayer ? m_options.engineB : m_options.engineA;
+
+        GameResult result = selfPlay.playGame(playerConfig, aiConfig, openingSeed, m_options.play);
+
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        if (m_stop) break; // test already decided, dont count or record games that finished after
+
+        if (m_recordWriter.isOpen()) {
+            m_recordWriter.write(selfPlay.getLastGameRecord());
+        }
+
+        if (m_searchStatsFile.is_open()) {
+            writeSearchStats(game, aIsPlayer, selfPlay.getLastGameSearchStats());
+        }
+
+        if (result == GameResult::DRAW) {
+            m_stats.draws++;
+        }
+        else if ((result == GameResult::PLAYER_WIN) == aIsPlayer) {
+            m_stats.wins++;
+        }
+        else {
+            m_stats.losses++;
+        }
+
+        int played = m_stats.games();
+        if (played % 100 == 0 && played < m_options.games) {
+            std::cout << "  " << played << " games: +" << m_stats.wins << " =" << m_stats.draws
+                << " -" << m_stats.losses;
+            if (m_options.sprt.enabled) {
+                std::cout << "  LLR " << m_stats.llr(m_options.sprt.elo0, m_options.sprt.elo1);
+            }
+            std::cout << std::endl;
+        }
+
+        if (m_options.sprt.enabled) {
+            checkSprt();
+        }
+    }
+}
+
+void Tournament::checkSprt()
+{
+    double llr = m_stats.llr(m_options.sprt.elo0, m_options.sprt.elo1);
+
+    if (llr >= m_options.sprt.upperBound()) {
+        m_sprtResult = SprtResult::H1_ACCEPTED;
+        m_stop = true;
+    }
+    else if (llr <= m_options.sprt.lowerBound()) {
+        m_sprtResult = SprtResult::H0_ACCEPTED;
+        m_stop = true;
+    }
+}
+
+void Tournament::printStats(const TournamentStats& stats, double seconds)
+{
+    std::streamsize oldPrecision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Games: " << stats.games() << "  +" << stats.wins << " =" << stats.draws << " -" << stats.losses
+        << "  score " << std::setprecision(3) << stats.score() << std::setprecision(1) << std::endl;
+    std::cout << "Elo: " << stats.elo() << " +/- " << stats.eloError() << " (95%)" << std::endl;
+
+    if (seconds > 0.0) {
+        std::cout << "Time: " << seconds << "s, " << (stats.games() * 60.0 / seconds) << " games/min" << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout.precision(oldPrecision);
+}
+
+void Tournament::writeSearchStats(int game, bool aIsPlayer, const std::vector<SearchStats>& searches)
+{
+    // Movement plies alternate starting with the player, passes included
+    for (size_t ply = 0; ply < searches.size(); ply++) {
+        bool isEngineA = (ply % 2 == 0) == aIsPlayer;
+        m_searchTotals[isEngineA ? 0 : 1].add(searches[ply]);
+
+        m_searchStatsFile << game << ',' << (isEngineA ? m_options.engineA.name : m_options.engineB.name) << ',' << ply << ',';
+        searches[ply].writeCsvRow(m_searchStatsFile);
+        m_searchStatsFile << '\n';
+    }
+}
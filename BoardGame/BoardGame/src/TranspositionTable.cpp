@@ -0,0 +1,204 @@
+#include "TranspositionTable.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared slots need lock free 64 bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared header needs lock free 32 bit atomics");
+
+namespace {
+
+constexpr char MAGIC[4] = { 'B', 'G', 'T', 'T' };
+constexpr uint32_t VERSION = 1;
+constexpr size_t MAX_ENTRY_COUNT_LOG2 = 32;
+
+// Packed entry: score in the low 32 bits, then depth, bound, from and to a byte each. An empty slot is all
+// zero, which is bound NONE.
+TTEntry unpack(uint64_t key, uint64_t data)
+{
+    TTEntry entry;
+    entry.key = key;
+    entry.score = (int32_t)(uint32_t)data;
+    entry.depth = (int8_t)(uint8_t)(data >> 32);
+    entry.bound = (TTBound)(uint8_t)(data >> 40);
+    entry.fromCell = (uint8_t)(data >> 48);
+    entry.toCell = (uint8_t)(data >> 56);
+    return entry;
+}
+
+} // namespace
+
+TTBackend& TTBackend::active()
+{
+    static TTBackend backend;
+    return backend;
+}
+
+TranspositionTable::TranspositionTable(size_t entryCountLog2)
+    : m_ownSlots(new Slot[size_t(1) << entryCountLog2])
+    , m_slots(m_ownSlots.get())
+    , m_mask((uint64_t(1) << entryCountLog2) - 1)
+{
+    clear();
+}
+
+TranspositionTable::~TranspositionTable() {}
+
+uint64_t TranspositionTable::pack(int score, int depth, TTBound bound, uint8_t fromCell, uint8_t toCell)
+{
+    return (uint64_t)(uint32_t)score | (uint64_t)(uint8_t)depth << 32 | (uint64_t)(uint8_t)bound << 40
+        | (uint64_t)fromCell << 48 | (uint64_t)toCell << 56;
+}
+
+// Writes the header of a table this process just created, or waits for the creator to finish one
+bool TranspositionTable::attach(SharedMemory& memory, bool created, size_t entryCountLog2)
+{
+    if (memory.size() < sizeof(Header)) return false;
+    Header* header = reinterpret_cast<Header*>(memory.data());
+
+    if (created) {
+        std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+        header->version = VERSION;
+        header->entryCountLog2 = (uint32_t)entryCountLog2;
+        header->ready.store(1, std::memory_order_release);
+    }
+    else {
+        for (int attempt = 0; attempt < 200 && header->ready.load(std::memory_order_acquire) == 0; attempt++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        if (header->ready.load(std::memory_order_acquire) == 0) return false;
+    }
+
+    return std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0 && header->version == VERSION
+        && header->entryCountLog2 <= MAX_ENTRY_COUNT_LOG2
+        && memory.size() >= sizeof(Header) + (sizeof(Slot) << header->entryCountLog2);
+}
+
+bool TranspositionTable::open(const TTBackend& backend)
+{
+    if (!backend.isShared() || backend.entryCountLog2 > MAX_ENTRY_COUNT_LOG2) return false;
+
+    std::unique_ptr<SharedMemory> memory(new SharedMemory());
+    size_t size = sizeof(Header) + (sizeof(Slot) << backend.entryCountLog2);
+    bool created = false;
+    bool opened = backend.filePath.empty()
+        ? memory->openNamed(backend.sharedName, size, created)
+        : memory->openFile(backend.filePath, size, created);
+    if (!opened || !attach(*memory, created, backend.entryCountLog2)) return false;
+
+    // A fresh mapping is zero filled, which is every slot empty
+    const Header* header = reinterpret_cast<const Header*>(memory->data());
+    m_mask = (uint64_t(1) << header->entryCountLog2) - 1;
+    m_slots = reinterpret_cast<Slot*>(memory->data() + sizeof(Header));
+    m_shared = std::move(memory);
+    m_ownSlots.reset();
+    m_created = created;
+    return true;
+}
+
+void TranspositionTable::clear()
+{
+    for (uint64_t i = 0; i <= m_mask; i++) {
+        m_slots[i].check.store(0, std::memory_order_relaxed);
+        m_slots[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const
+{
+    const Slot& slot = m_slots[key & m_mask];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((check ^ data) != key) return false;
+
+    TTEntry found = unpack(key, data);
+    if (found.bound == TTBound::NONE) return false;
+    entry = found;
+    return true;
+}
+
+void TranspositionTable::store(uint64_t key, int score, int depth, TTBound bound, uint8_t fromCell, uint8_t toCell)
+{
+    Slot& slot = m_slots[key & m_mask];
+    uint64_t oldData = slot.data.load(std::memory_order_relaxed);
+    TTEntry old = unpack(key, oldData);
+    if ((slot.check.load(std::memory_order_relaxed) ^ oldData) == key && old.bound != TTBound::NONE) {
+        if (old.depth > depth) return;
+
+        // A shallower result for the same position still knows a move worth trying first
+        if (fromCell == NO_CELL) {
+            fromCell = old.fromCell;
+            toCell = old.toCell;
+        }
+    }
+
+    uint64_t data = pack(score, depth, bound, fromCell, toCell);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.entryCountLog2 = 0;
+    while ((uint64_t(1) << header.entryCountLog2) <= m_mask) header.entryCountLog2++;
+    header.ready.store(1, std::memory_order_relaxed);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Slot by slot, other engines may be writing to a shared table meanwhile
+    uint64_t words[2 * 1024];
+    for (uint64_t first = 0; first <= m_mask; first += 1024) {
+        uint64_t count = std::min<uint64_t>(1024, m_mask + 1 - first);
+        for (uint64_t i = 0; i < count; i++) {
+            words[2 * i] = m_slots[first + i].check.load(std::memory_order_relaxed);
+            words[2 * i + 1] = m_slots[first + i].data.load(std::memory_order_relaxed);
+        }
+        file.write(reinterpret_cast<const char*>(words), (std::streamsize)(count * sizeof(Slot)));
+    }
+    return (bool)file;
+}
+
+bool TranspositionTable::load(const std::string& path)
+{
+    MappedFile file;
+    if (!file.open(path) || file.size() < sizeof(Header)) return false;
+
+    const Header* header = reinterpret_cast<const Header*>(file.data());
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION
+        || header->entryCountLog2 > MAX_ENTRY_COUNT_LOG2
+        || file.size() < sizeof(Header) + (sizeof(Slot) << header->entryCountLog2)) {
+        return false;
+    }
+
+    // Stored again rather than copied, so the saved table can be any size and a deeper entry already here wins
+    const unsigned char* slots = file.data() + sizeof(Header);
+    for (uint64_t i = 0; i < (uint64_t(1) << header->entryCountLog2); i++) {
+        uint64_t check, data;
+        std::memcpy(&check, slots + i * sizeof(Slot), sizeof(check));
+        std::memcpy(&data, slots + i * sizeof(Slot) + sizeof(check), sizeof(data));
+
+        TTEntry entry = unpack(check ^ data, data);
+        if (entry.bound == TTBound::NONE || (entry.key & ((uint64_t(1) << header->entryCountLog2) - 1)) != i) continue;
+        store(entry.key, entry.score, entry.depth, entry.bound, entry.fromCell, entry.toCell);
+    }
+    return true;
+}
+
+int TranspositionTable::getPermilleFull() const
+{
+    size_t sample = std::min<size_t>(1000, getSize());
+    int used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        uint64_t data = m_slots[i].data.load(std::memory_order_relaxed);
+        if (unpack(0, data).bound != TTBound::NONE) used++;
+    }
+    return (int)(used * 1000 / sample);
+}
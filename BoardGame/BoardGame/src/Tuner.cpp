@@ -0,0 +1,651 @@
+#include "Tuner.h"
+#include "NetTrainer.h"
+#include "Frog.h"
+#include "Snake.h"
+#include "Donkey.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+constexpr char DATA_MAGIC[4] = { 'B', 'G', 'T', '2' };
+constexpr int CLASS_COUNT = 6;   // squares of the 5x5 board that are equal under its symmetries
+constexpr size_t BLOCK_SIZE = 4096;
+
+// Representative square (col, row) of each symmetry class
+constexpr int CLASS_SQUARES[CLASS_COUNT][2] = { {0,0}, {1,0}, {2,0}, {1,1}, {2,1}, {2,2} };
+
+// Eval weights tuned, in order
+enum EvalWeight { LINE_THREE, LINE_TWO, LINE_ONE, OFFENSE, DEFENSE, CENTER, CENTER_CLASS_0 };
+constexpr int EVAL_WEIGHTS = CENTER_CLASS_0 + CLASS_COUNT;
+
+// Eval feature columns: own 3/2/1 lines, opponent 3/2/1 lines, centre class counts (own minus opponent)
+constexpr int EVAL_COLUMNS = 6 + CLASS_COUNT;
+
+// Placement weights tuned, in order
+enum PlacementWeight { PLACE_CENTER, FRIENDLY, OPPONENT, BLOCKING, OFFENSIVE, PLACE_CLASS_0 };
+constexpr int PLACEMENT_WEIGHTS = PLACE_CLASS_0 + CLASS_COUNT;
+
+// Placement feature columns: chosen square class (one hot), eval after / 3, the four neighbour/line features
+constexpr int PLACEMENT_COLUMNS = CLASS_COUNT + 5;
+
+PieceOwner otherSide(PieceOwner owner)
+{
+    return owner == PieceOwner::PLAYER ? PieceOwner::AI : PieceOwner::PLAYER;
+}
+
+} // namespace
+
+class Tuner::WorkerPool
+{
+public:
+    // threads - 1 helpers, the thread calling run works on slice 0 itself
+    explicit WorkerPool(int threads)
+    {
+        for (int i = 1; i < threads; i++) {
+            m_helpers.emplace_back(&WorkerPool::work, this, i);
+        }
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_wake.notify_all();
+        for (auto& t : m_helpers) {
+            t.join();
+        }
+    }
+
+    // Calls task(slice) once for every slice, returns when all of them are done
+    void run(const std::function<void(int)>& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_task = &task;
+            m_pending = (int)m_helpers.size();
+            m_generation++;
+        }
+        m_wake.notify_all();
+        task(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_pending == 0; });
+    }
+
+private:
+    void work(int slice)
+    {
+        uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(int)>* task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_quit || m_generation != seen; });
+                if (m_quit) return;
+                seen = m_generation;
+                task = m_task;
+            }
+
+            (*task)(slice);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0) m_done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> m_helpers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(int)>* m_task = nullptr;
+    uint64_t m_generation = 0; // bumped once per run call
+    int m_pending = 0;         // helpers still working on this generation
+    bool m_quit = false;
+};
+
+Tuner::Tuner(const TunerOptions& options)
+    : m_options(options)
+{
+    m_threads = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+    m_threads = std::max(1, m_threads);
+
+    for (PieceOwner owner : { PieceOwner::PLAYER, PieceOwner::AI }) {
+        m_pieces.push_back(std::make_unique<Frog>(owner, ""));
+        m_pieces.push_back(std::make_unique<Snake>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+        m_pieces.push_back(std::make_unique<Donkey>(owner, ""));
+    }
+}
+
+Tuner::~Tuner()
+{
+}
+
+bool Tuner::prepareSamples()
+{
+    if (m_options.dataPath.empty() || !loadPositions(m_options.dataPath)) {
+        generatePositions();
+        if (!m_options.dataPath.empty()) {
+            savePositions(m_options.dataPath);
+        }
+    }
+
+    if (m_samples.empty()) {
+        std::cout << "Tuner: no positions to tune on" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Tuner::run()
+{
+    auto start = std::chrono::steady_clock::now();
+    if (!prepareSamples()) return false;
+    m_workers.reset(new WorkerPool(m_threads));
+
+    EvalParams params = EvalParams::active();
+
+    // Board evaluation weights
+    std::vector<int> evalWeights(EVAL_WEIGHTS);
+    evalWeights[LINE_THREE] = params.lineThree;
+    evalWeights[LINE_TWO] = params.lineTwo;
+    evalWeights[LINE_ONE] = params.lineOne;
+    evalWeights[OFFENSE] = params.offenseWeight;
+    evalWeights[DEFENSE] = params.defenseWeight;
+    evalWeights[CENTER] = params.centerWeight;
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        evalWeights[CENTER_CLASS_0 + c] = params.centerValues[CLASS_SQUARES[c][1]][CLASS_SQUARES[c][0]];
+    }
+
+    FeatureSet evalSet;
+    buildEvalFeatures(evalSet);
+
+    std::vector<float> coefficients;
+    evalCoefficients(evalWeights, coefficients);
+    double evalK = fitScale(evalSet, coefficients);
+
+    std::cout << "Tuner: " << evalSet.count << " movement positions, K = " << evalK
+        << ", loss " << computeLoss(evalSet, coefficients, evalK) << std::endl;
+
+    double evalLoss = localSearch(evalSet, evalWeights, evalCoefficients, evalK);
+    std::cout << "Tuner: eval loss after tuning " << evalLoss << std::endl;
+
+    params.lineThree = evalWeights[LINE_THREE];
+    params.lineTwo = evalWeights[LINE_TWO];
+    params.lineOne = evalWeights[LINE_ONE];
+    params.offenseWeight = evalWeights[OFFENSE];
+    params.defenseWeight = evalWeights[DEFENSE];
+    params.centerWeight = evalWeights[CENTER];
+
+    // Placement heuristic weights, features use the freshly tuned board evaluation
+    std::vector<int> placementWeights(PLACEMENT_WEIGHTS);
+    placementWeights[PLACE_CENTER] = params.placementCenterWeight;
+    placementWeights[FRIENDLY] = params.friendlyNeighborWeight;
+    placementWeights[OPPONENT] = params.opponentNeighborWeight;
+    placementWeights[BLOCKING] = params.blockingWeight;
+    placementWeights[OFFENSIVE] = params.offensiveWeight;
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        placementWeights[PLACE_CLASS_0 + c] = params.placementValues[CLASS_SQUARES[c][1]][CLASS_SQUARES[c][0]];
+    }
+
+    for (int col = 0; col < 5; col++) {
+        for (int row = 0; row < 5; row++) {
+            params.centerValues[row][col] = evalWeights[CENTER_CLASS_0 + symmetryClass(col, row)];
+        }
+    }
+
+    FeatureSet placementSet;
+    buildPlacementFeatures(placementSet, params);
+
+    if (placementSet.count > 0) {
+        placementCoefficients(placementWeights, coefficients);
+        double placementK = fitScale(placementSet, coefficients);
+
+        std::cout << "Tuner: " << placementSet.count << " placement decisions, K = " << placementK
+            << ", loss " << computeLoss(placementSet, coefficients, placementK) << std::endl;
+
+        double placementLoss = localSearch(placementSet, placementWeights, placementCoefficients, placementK);
+        std::cout << "Tuner: placement loss after tuning " << placementLoss << std::endl;
+
+        params.placementCenterWeight = placementWeights[PLACE_CENTER];
+        params.friendlyNeighborWeight = placementWeights[FRIENDLY];
+        params.opponentNeighborWeight = placementWeights[OPPONENT];
+        params.blockingWeight = placementWeights[BLOCKING];
+        params.offensiveWeight = placementWeights[OFFENSIVE];
+        for (int col = 0; col < 5; col++) {
+            for (int row = 0; row < 5; row++) {
+                params.placementValues[row][col] = placementWeights[PLACE_CLASS_0 + symmetryClass(col, row)];
+            }
+        }
+    }
+
+    if (!params.save(m_options.outPath)) {
+        std::cout << "Tuner: cannot write " << m_options.outPath << std::endl;
+        return false;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Tuner: wrote " << m_options.outPath << " (" << seconds << "s)" << std::endl;
+    return true;
+}
+
+bool Tuner::runNetwork()
+{
+    auto start = std::chrono::steady_clock::now();
+    if (!prepareSamples()) return false;
+
+    // Movement positions still in play, the search scores finished games itself
+    std::vector<NetSample> samples;
+    for (const LabelledSample& labelled : m_samples) {
+        if (labelled.position.placeCol >= 0) continue;
+
+        GameState state;
+        buildState(labelled.position, state);
+        if (state.getWinner() != PieceOwner::NONE) continue;
+
+        PieceOwner side = labelled.position.sideToMove;
+        NetSample sample;
+        for (int col = 0; col < 5; col++) {
+            for (int row = 0; row < 5; row++) {
+                Piece* p = state.getPieceAt(col, row);
+                if (!p) continue;
+                sample.features[sample.featureCount++] =
+                    (uint8_t)NeuralNet::featureIndex(side, p->getOwner(), p->getType(), col * 5 + row);
+            }
+        }
+        sample.heuristic = state.evaluate(side);
+        sample.result = labelled.result;
+        samples.push_back(sample);
+    }
+
+    NetTrainOptions trainOptions;
+    trainOptions.epochs = m_options.epochs;
+    trainOptions.seed = m_options.seed;
+
+    NeuralNet network;
+    NetTrainer trainer(trainOptions);
+    if (!trainer.train(samples, network)) return false;
+
+    if (!network.save(m_options.outPath)) {
+        std::cout << "Tuner: cannot write " << m_options.outPath << std::endl;
+        return false;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Tuner: wrote " << m_options.outPath << " (" << seconds << "s)" << std::endl;
+    return true;
+}
+
+void Tuner::generatePositions()
+{
+    std::cout << "Tuner: generating positions from " << m_options.games << " self-play games at depth "
+        << m_options.depth << " on " << m_threads << " threads" << std::endl;
+
+    std::atomic<int> nextGame(0);
+    std::mutex samplesMutex;
+
+    EngineConfig config;
+    config.depth = m_options.depth;
+
+    auto worker = [&]() {
+        SelfPlay selfPlay;
+        selfPlay.setRecordSamples(true);
+
+        for (;;) {
+            int game = nextGame++;
+            if (game >= m_options.games) break;
+
+            // One extra random placement per game, cycling through the plies, gives unbiased placement samples
+            SelfPlayOptions playOptions;
+            playOptions.randomPlacements = m_options.randomPlacements;
+            playOptions.exploratoryPlacement = game % 10;
+
+            GameResult result = selfPlay.playGame(config, config, m_options.seed * 1000003ull + (uint64_t)game, playOptions);
+
+            std::lock_guard<std::mutex> lock(samplesMutex);
+            for (const PositionSample& position : selfPlay.getLastGameSamples()) {
+                LabelledSample sample;
+                sample.position = position;
+
+                if (result == GameResult::DRAW) {
+                    sample.result = 0.5f;
+                }
+                else {
+                    bool playerWon = (result == GameResult::PLAYER_WIN);
+                    sample.result = ((position.sideToMove == PieceOwner::PLAYER) == playerWon) ? 1.0f : 0.0f;
+                }
+                m_samples.push_back(sample);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < m_threads; i++) {
+        workers.emplace_back(worker);
+    }
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    std::cout << "Tuner: " << m_samples.size() << " labelled positions" << std::endl;
+}
+
+bool Tuner::loadPositions(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+
+    char magic[4];
+    uint32_t count = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+
+    if (!in || std::memcmp(magic, DATA_MAGIC, sizeof(magic)) != 0) {
+        std::cout << "Tuner: " << path << " is not a position file" << std::endl;
+        return false;
+    }
+
+    // Record: 25 board bytes, side, place col, place row, place type, random flag, result in half points
+    m_samples.clear();
+    m_samples.reserve(count);
+    for (uint32_t i = 0; i < count && in; i++) {
+        unsigned char record[31];
+        in.read(reinterpret_cast<char*>(record), sizeof(record));
+        if (!in) break;
+
+        LabelledSample sample;
+        std::memcpy(sample.position.board, record, 25);
+        sample.position.sideToMove = record[25] ? PieceOwner::AI : PieceOwner::PLAYER;
+        sample.position.placeCol = (int8_t)record[26];
+        sample.position.placeRow = (int8_t)record[27];
+        sample.position.placeType = (PieceType)record[28];
+        sample.position.randomChoice = record[29] != 0;
+        sample.result = record[30] * 0.5f;
+        m_samples.push_back(sample);
+    }
+
+    std::cout << "Tuner: loaded " << m_samples.size() << " positions from " << path << std::endl;
+    return !m_samples.empty();
+}
+
+bool Tuner::savePositions(const std::string& path) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    uint32_t count = (uint32_t)m_samples.size();
+    out.write(DATA_MAGIC, sizeof(DATA_MAGIC));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+    for (const LabelledSample& sample : m_samples) {
+        unsigned char record[31];
+        std::memcpy(record, sample.position.board, 25);
+        record[25] = sample.position.sideToMove == PieceOwner::AI ? 1 : 0;
+        record[26] = (unsigned char)sample.position.placeCol;
+        record[27] = (unsigned char)sample.position.placeRow;
+        record[28] = (unsigned char)sample.position.placeType;
+        record[29] = sample.position.randomChoice ? 1 : 0;
+        record[30] = (unsigned char)std::lround(sample.result * 2.0f);
+        out.write(reinterpret_cast<const char*>(record), sizeof(record));
+    }
+
+    return static_cast<bool>(out);
+}
+
+void Tuner::buildState(const PositionSample& sample, GameState& state) const
+{
+    int used[6] = {}; // pool index per owner and type, donkeys are interchangeable
+
+    for (int col = 0; col < 5; col++) {
+        for (int row = 0; row < 5; row++) {
+            int code = sample.board[col][row];
+            if (code == 0) continue;
+
+            int ownerIndex = (code - 1) / 3;
+            int type = (code - 1) % 3;
+            int offset = (type == (int)PieceType::DONKEY) ? 2 + used[ownerIndex * 3 + type]++ : type;
+            state.applyPlacement(col, row, m_pieces[ownerIndex * 5 + std::min(offset, 4)].get(), false);
+        }
+    }
+}
+
+void Tuner::buildEvalFeatures(FeatureSet& set) const
+{
+    std::vector<const LabelledSample*> movement;
+    for (const LabelledSample& sample : m_samples) {
+        if (sample.position.placeCol < 0) movement.push_back(&sample);
+    }
+
+    set.columns = EVAL_COLUMNS;
+    set.count = movement.size();
+    set.values.assign(set.columns * set.count, 0.0f);
+    set.results.resize(set.count);
+
+    for (size_t i = 0; i < set.count; i++) {
+        GameState state;
+        buildState(movement[i]->position, state);
+
+        PieceOwner side = movement[i]->position.sideToMove;
+        int counts[2][3];
+        state.getLineCounts(side, counts[0][0], counts[0][1], counts[0][2]);
+        state.getLineCounts(otherSide(side), counts[1][0], counts[1][1], counts[1][2]);
+
+        for (int c = 0; c < 6; c++) {
+            set.values[c * set.count + i] = (float)counts[c / 3][c % 3];
+        }
+
+        for (int col = 0; col < 5; col++) {
+            for (int row = 0; row < 5; row++) {
+                Piece* p = state.getPieceAt(col, row);
+                if (!p) continue;
+                float sign = (p->getOwner() == side) ? 1.0f : -1.0f;
+                set.values[(6 + symmetryClass(col, row)) * set.count + i] += sign;
+            }
+        }
+
+        set.results[i] = movement[i]->result;
+    }
+}
+
+void Tuner::buildPlacementFeatures(FeatureSet& set, const EvalParams& params) const
+{
+    // Only squares picked at random: the engine's own choices depend on the position and bias the fit
+    std::vector<const LabelledSample*> decisions;
+    for (const LabelledSample& sample : m_samples) {
+        if (sample.position.placeCol >= 0 && sample.position.randomChoice) decisions.push_back(&sample);
+    }
+
+    set.columns = PLACEMENT_COLUMNS;
+    set.count = decisions.size();
+    set.values.assign(set.columns * set.count, 0.0f);
+    set.results.resize(set.count);
+
+    for (size_t i = 0; i < set.count; i++) {
+        const PositionSample& position = decisions[i]->position;
+
+        GameState state;
+        buildState(position, state);
+
+        // Any unused pool piece of the right type works, only owner and type matter to the heuristic
+        int ownerIndex = (position.sideToMove == PieceOwner::PLAYER) ? 0 : 1;
+        int type = (int)position.placeType;
+        Piece* piece = m_pieces[ownerIndex * 5 + (type == (int)PieceType::DONKEY ? 4 : type)].get();
+
+        MiniMax engine(position.sideToMove);
+        engine.setVerbose(false);
+        engine.setEvalParams(&params);
+
+        // The heuristic only ranks squares, so fit how much better the chosen square scored than the
+        // average legal square rather than its raw score, which mostly describes the position.
+        auto placements = state.getLegalPlacements();
+        float weight = -1.0f / (float)placements.size();
+
+        for (const auto& [col, row] : placements) {
+            bool chosen = (col == position.placeCol && row == position.placeRow);
+            addPlacementFeatures(set, i, engine, state, col, row, piece, chosen ? 1.0f + weight : weight);
+        }
+
+        set.results[i] = decisions[i]->result;
+    }
+}
+
+void Tuner::addPlacementFeatures(FeatureSet& set, size_t index, const MiniMax& engine, const GameState& state,
+    int col, int row, Piece* piece, float weight) const
+{
+    PlacementFeatures features;
+    engine.getPlacementFeatures(state, col, row, piece, features);
+
+    set.values[symmetryClass(col, row) * set.count + index] += weight;
+    set.values[(CLASS_COUNT + 0) * set.count + index] += weight * (float)(features.evalAfter / 3);
+    set.values[(CLASS_COUNT + 1) * set.count + index] += weight * (float)features.friendlyNeighbors;
+    set.values[(CLASS_COUNT + 2) * set.count + index] += weight * (float)features.opponentNeighbors;
+    set.values[(CLASS_COUNT + 3) * set.count + index] += weight * (float)features.blocking;
+    set.values[(CLASS_COUNT + 4) * set.count + index] += weight * (float)features.offensive;
+}
+
+void Tuner::evalCoefficients(const std::vector<int>& weights, std::vector<float>& coefficients)
+{
+    // evaluate() = offense * lines(own) - defense * lines(opponent) + center * (centre(own) - centre(opponent))
+    coefficients.assign(EVAL_COLUMNS, 0.0f);
+    coefficients[0] = (float)(weights[OFFENSE] * weights[LINE_THREE]);
+    coefficients[1] = (float)(weights[OFFENSE] * weights[LINE_TWO]);
+    coefficients[2] = (float)(weights[OFFENSE] * weights[LINE_ONE]);
+    coefficients[3] = (float)(-weights[DEFENSE] * weights[LINE_THREE]);
+    coefficients[4] = (float)(-weights[DEFENSE] * weights[LINE_TWO]);
+    coefficients[5] = (float)(-weights[DEFENSE] * weights[LINE_ONE]);
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        coefficients[6 + c] = (float)(weights[CENTER] * weights[CENTER_CLASS_0 + c]);
+    }
+}
+
+void Tuner::placementCoefficients(const std::vector<int>& weights, std::vector<float>& coefficients)
+{
+    coefficients.assign(PLACEMENT_COLUMNS, 0.0f);
+    for (int c = 0; c < CLASS_COUNT; c++) {
+        coefficients[c] = (float)(weights[PLACE_CENTER] * weights[PLACE_CLASS_0 + c]);
+    }
+    coefficients[CLASS_COUNT + 0] = 1.0f;
+    coefficients[CLASS_COUNT + 1] = (float)weights[FRIENDLY];
+    coefficients[CLASS_COUNT + 2] = (float)weights[OPPONENT];
+    coefficients[CLASS_COUNT + 3] = (float)weights[BLOCKING];
+    coefficients[CLASS_COUNT + 4] = (float)weights[OFFENSIVE];
+}
+
+double Tuner::computeLoss(const FeatureSet& set, const std::vector<float>& coefficients, double k) const
+{
+    if (set.count == 0) return 0.0;
+
+    std::vector<double> partial(m_threads, 0.0);
+    size_t perThread = (set.count + m_threads - 1) / m_threads;
+    float scale = (float)k;
+
+    std::function<void(int)> worker = [&](int thread) {
+        size_t begin = thread * perThread;
+        size_t end = std::min(set.count, begin + perThread);
+        float eval[BLOCK_SIZE];
+        double sum = 0.0;
+
+        for (size_t block = begin; block < end; block += BLOCK_SIZE) {
+            size_t n = std::min(BLOCK_SIZE, end - block);
+
+            // eval = features . coefficients, one column at a time so each pass is a plain multiply add
+            std::fill(eval, eval + n, 0.0f);
+            for (int c = 0; c < set.columns; c++) {
+                const float weight = coefficients[c];
+                const float* column = set.values.data() + c * set.count + block;
+                for (size_t i = 0; i < n; i++) {
+                    eval[i] += weight * column[i];
+                }
+            }
+
+            const float* results = set.results.data() + block;
+            for (size_t i = 0; i < n; i++) {
+                float predicted = 1.0f / (1.0f + std::exp(-scale * eval[i]));
+                float error = results[i] - predicted;
+                sum += error * error;
+            }
+        }
+        partial[thread] = sum;
+    };
+
+    m_workers->run(worker);
+
+    double total = 0.0;
+    for (double sum : partial) total += sum;
+    return total / set.count;
+}
+
+double Tuner::fitScale(const FeatureSet& set, const std::vector<float>& coefficients) const
+{
+    // Loss is unimodal in K, golden section search over a log scale
+    double lo = std::log(1e-6), hi = std::log(1e-1);
+    const double ratio = 0.6180339887;
+
+    for (int i = 0; i < 40; i++) {
+        double a = hi - ratio * (hi - lo);
+        double b = lo + ratio * (hi - lo);
+        if (computeLoss(set, coefficients, std::exp(a)) < computeLoss(set, coefficients, std::exp(b))) {
+            hi = b;
+        }
+        else {
+            lo = a;
+        }
+    }
+
+    return std::exp((lo + hi) / 2.0);
+}
+
+double Tuner::localSearch(const FeatureSet& set, std::vector<int>& weights, CoefficientFn toCoefficients, double k) const
+{
+    std::vector<float> coefficients;
+    toCoefficients(weights, coefficients);
+    double bestLoss = computeLoss(set, coefficients, k);
+
+    for (int iteration = 0; iteration < m_options.maxIterations; iteration++) {
+        bool improved = false;
+
+        for (size_t w = 0; w < weights.size(); w++) {
+            for (int step : { 1, -1 }) {
+                weights[w] += step;
+                toCoefficients(weights, coefficients);
+                double loss = computeLoss(set, coefficients, k);
+
+                if (loss < bestLoss) {
+                    bestLoss = loss;
+                    improved = true;
+                    break;
+                }
+                weights[w] -= step;
+            }
+        }
+
+        if (!improved) break;
+    }
+
+    return bestLoss;
+}
+
+int Tuner::symmetryClass(int col, int row)
+{
+    int a = std::min(col, 4 - col);
+    int b = std::min(row, 4 - row);
+    if (a > b) std::swap(a, b);
+
+    // (0,0) corner, (0,1), (0,2) edges, (1,1), (1,2) inner ring, (2,2) centre
+    if (a == 0) return b;
+    if (a == 1) return 2 + b;
+    return 5;
+}
@@ -13,13 +13,373 @@
 #endif 
 
 #include <iostream>
+#include <string>
+#include <cstdlib>
 #include "Game.h"
+#include "AnalysisServer.h"
+#include "Bench.h"
+#include "EngineProtocol.h"
+#include "OpeningBook.h"
+#include "Profiler.h"
+#include "Tournament.h"
+#include "TranspositionTable.h"
+#include "Tuner.h"
 
+// Value following a --name flag, or the fallback when it isnt given
+static std::string getOption(int argc, char* argv[], const std::string& name, const std::string& fallback)
+{
+	for (int i = 1; i + 1 < argc; i++)
+	{
+		if (name == argv[i]) return argv[i + 1];
+	}
+	return fallback;
+}
+
+// True when a switch without a value is on the command line
+static bool hasFlag(int argc, char* argv[], const std::string& name)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (name == argv[i]) return true;
+	}
+	return false;
+}
+
+static int getIntOption(int argc, char* argv[], const std::string& name, int fallback)
+{
+	return std::atoi(getOption(argc, argv, name, std::to_string(fallback)).c_str());
+}
+
+static double getDoubleOption(int argc, char* argv[], const std::string& name, double fallback)
+{
+	return std::atof(getOption(argc, argv, name, std::to_string(fallback)).c_str());
+}
 
-int main()
+// Comma separated selective search features to switch on: lmr, futility, razor, threats, forced, or all / none
+static SearchFeatures parseSearchFeatures(const std::string& list)
 {
+	SearchFeatures features;
+	if (list == "all") return features;
+
+	features.lateMoveReductions = list.find("lmr") != std::string::npos;
+	features.futilityPruning = list.find("futility") != std::string::npos;
+	features.razoring = list.find("razor") != std::string::npos;
+	features.threatSearch = list.find("threats") != std::string::npos;
+	features.forcedMoves = list.find("forced") != std::string::npos;
+	return features;
+}
+
+static void loadEngineParams(EngineConfig& config, const std::string& path)
+{
+	if (!path.empty() && !config.params.load(path))
+	{
+		std::cout << "Could not load weights from " << path << ", using the defaults" << std::endl;
+	}
+}
+
+// Per engine network for comparisons, "none" for the line heuristic even when --nnue is loaded
+static void loadEngineNetwork(EngineConfig& config, NeuralNet& network, const std::string& path)
+{
+	if (path == "none")
+	{
+		config.network = nullptr;
+	}
+	else if (!path.empty())
+	{
+		if (network.load(path)) config.network = &network;
+		else std::cout << "Could not load network " << path << ", engine " << config.name << " keeps its default" << std::endl;
+	}
+}
+
+static TournamentOptions getTournamentOptions(int argc, char* argv[], int defaultGames)
+{
+	TournamentOptions options;
+	options.engineA.name = getOption(argc, argv, "--name-a", "A");
+	options.engineA.depth = getIntOption(argc, argv, "--depth-a", 3);
+	options.engineA.nodes = (uint64_t)getIntOption(argc, argv, "--nodes-a", 0);
+	loadEngineParams(options.engineA, getOption(argc, argv, "--params-a", ""));
+	options.engineA.features = parseSearchFeatures(getOption(argc, argv, "--features-a", "all"));
+	static NeuralNet networkA, networkB; // outlive every game of the run
+	loadEngineNetwork(options.engineA, networkA, getOption(argc, argv, "--nnue-a", ""));
+	options.engineB.name = getOption(argc, argv, "--name-b", "B");
+	options.engineB.depth = getIntOption(argc, argv, "--depth-b", 3);
+	options.engineB.nodes = (uint64_t)getIntOption(argc, argv, "--nodes-b", 0);
+	loadEngineParams(options.engineB, getOption(argc, argv, "--params-b", ""));
+	options.engineB.features = parseSearchFeatures(getOption(argc, argv, "--features-b", "all"));
+	loadEngineNetwork(options.engineB, networkB, getOption(argc, argv, "--nnue-b", ""));
+	options.games = getIntOption(argc, argv, "--games", defaultGames);
+	options.threads = getIntOption(argc, argv, "--threads", 0);
+	options.seed = (uint64_t)getIntOption(argc, argv, "--seed", 1);
+	options.play.randomPlacements = getIntOption(argc, argv, "--random-placements", 2);
+	options.play.maxPlies = getIntOption(argc, argv, "--max-plies", 200);
+	options.recordPath = getOption(argc, argv, "--record", "");
+	options.searchStatsPath = getOption(argc, argv, "--search-stats", "");
+	return options;
+}
+
+// Streams a game record file and prints totals, checks the file reads back cleanly
+static bool printRecordSummary(const std::string& path)
+{
+	GameRecordReader reader;
+	if (!reader.open(path))
+	{
+		std::cout << "Could not open game record " << path << std::endl;
+		return false;
+	}
+
+	GameRecord record;
+	long long games = 0, plies = 0, nodes = 0, micros = 0;
+	int results[4] = { 0, 0, 0, 0 };
+	while (reader.next(record))
+	{
+		games++;
+		plies += record.plies();
+		results[(int)record.result]++;
+		for (const PlyStats& ply : record.stats)
+		{
+			nodes += ply.nodes;
+			micros += ply.timeMicros;
+		}
+	}
+
+	std::cout << path << ": " << games << " games, " << plies << " plies" << std::endl;
+	std::cout << "  player wins " << results[(int)GameResult::PLAYER_WIN] << ", ai wins " << results[(int)GameResult::AI_WIN]
+		<< ", draws " << results[(int)GameResult::DRAW] << ", unfinished " << results[(int)GameResult::UNFINISHED]
+		<< std::endl;
+	if (nodes > 0)
+	{
+		std::cout << "  " << nodes << " nodes searched in " << micros / 1000 << " ms" << std::endl;
+	}
+	return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+	// Offline tools run without opening the window
+	std::string mode = argc > 1 ? argv[1] : "";
+
+	// Tuned evaluation weights replace the hand picked defaults when present
+	std::string paramsPath = getOption(argc, argv, "--params", EvalParams::DEFAULT_PATH);
+	if (EvalParams::active().load(paramsPath))
+	{
+		std::cout << "Loaded evaluation weights from " << paramsPath << std::endl;
+	}
+
+	// The evaluation network is opt in, every engine created afterwards searches with it
+	std::string networkPath = getOption(argc, argv, "--nnue", "");
+	if (!networkPath.empty())
+	{
+		if (!NeuralNet::active().load(networkPath))
+		{
+			std::cerr << "Cannot load evaluation network " << networkPath << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::cout << "Loaded evaluation network from " << networkPath << std::endl;
+	}
+
+	// --shared-hash <name> or --hash-file <path> puts every engine's transposition table in one mapping that
+	// other processes on the machine can share, --hash-size <log2 entries> sizes it when this run creates it
+	TTBackend& hashBackend = TTBackend::active();
+	hashBackend.sharedName = getOption(argc, argv, "--shared-hash", "");
+	hashBackend.filePath = getOption(argc, argv, "--hash-file", "");
+	hashBackend.entryCountLog2 = (size_t)getIntOption(argc, argv, "--hash-size", 20);
+	bool hashMode = mode == "--hash-save" || mode == "--hash-load" || mode == "--hash-remove"; // open it themselves
+	if (hashBackend.isShared() && !hashMode)
+	{
+		TranspositionTable table;
+		if (!table.open(hashBackend))
+		{
+			std::cerr << "Cannot open shared hash table "
+				<< (hashBackend.filePath.empty() ? hashBackend.sharedName : hashBackend.filePath) << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::cout << "Sharing a hash table of " << table.getSize() << " entries, " << table.getPermilleFull()
+			<< " permille full" << std::endl;
+		if (!hashBackend.sharedName.empty() && !SharedMemory::NAMED_OUTLIVES_PROCESSES)
+		{
+			std::cout << "A --shared-hash table is gone once the last process using it exits on this platform, "
+				"use --hash-file to keep one between runs" << std::endl;
+		}
+	}
+
+#ifdef BOARDGAME_PROFILE
+	// --trace <file.json> records frame and search timings for a trace viewer, written on exit
+	std::string tracePath = getOption(argc, argv, "--trace", "");
+	if (!tracePath.empty())
+	{
+		Profiler::get().begin(tracePath);
+	}
+#endif
+
+	if (mode == "--build-book") // --build-book [path] [plies] [depth]
+	{
+		std::string path = argc > 2 ? argv[2] : OpeningBook::DEFAULT_PATH;
+		int plies = argc > 3 ? std::atoi(argv[3]) : 4;
+		int depth = argc > 4 ? std::atoi(argv[4]) : 4;
+		return OpeningBook::build(path, plies, depth) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (mode == "--tournament") // headless self-play between two engine configs
+	{
+		Tournament tournament(getTournamentOptions(argc, argv, 1000));
+		tournament.run();
+		return EXIT_SUCCESS;
+	}
+
+	if (mode == "--sprt") // engine A is the change under test, engine B the baseline
+	{
+		TournamentOptions options = getTournamentOptions(argc, argv, 20000);
+		options.sprt.enabled = true;
+		options.sprt.elo0 = getDoubleOption(argc, argv, "--elo0", 0.0);
+		options.sprt.elo1 = getDoubleOption(argc, argv, "--elo1", 10.0);
+		options.sprt.alpha = getDoubleOption(argc, argv, "--alpha", 0.05);
+		options.sprt.beta = getDoubleOption(argc, argv, "--beta", 0.05);
+
+		Tournament tournament(options);
+		tournament.run();
+
+		// Exit code lets scripts gate on the result: 0 passed, 1 failed, 2 ran out of games
+		SprtResult result = tournament.getSprtResult();
+		return result == SprtResult::H1_ACCEPTED ? 0 : (result == SprtResult::H0_ACCEPTED ? 1 : 2);
+	}
+
+	if (mode == "--bench") // fixed positions and depth, for comparing search changes
+	{
+		BenchOptions options;
+		options.nodes = (uint64_t)getIntOption(argc, argv, "--nodes", 0); // deterministic node budget per search
+		options.depth = getIntOption(argc, argv, "--depth", options.nodes > 0 ? 0 : 4);
+		options.positions = getIntOption(argc, argv, "--positions", 32);
+		options.seed = (uint64_t)getIntOption(argc, argv, "--seed", 1);
+		options.lines = getIntOption(argc, argv, "--lines", 1);
+		options.features = parseSearchFeatures(getOption(argc, argv, "--features", "all"));
+		options.jsonPath = getOption(argc, argv, "--json", "");
+		options.csvPath = getOption(argc, argv, "--csv", "");
+
+		Bench bench(options);
+		bench.run();
+		return EXIT_SUCCESS;
+	}
+
+	if (mode == "--eval-bench") // batch evaluation kernels against GameState::evaluate, speed and exactness
+	{
+		EvalBenchOptions options;
+		options.positions = getIntOption(argc, argv, "--positions", 65536);
+		options.rounds = getIntOption(argc, argv, "--rounds", 20);
+		options.seed = (uint64_t)getIntOption(argc, argv, "--seed", 1);
+
+		EvalBench bench(options);
+		return bench.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (mode == "--rank-bench") // position ranking for dense tables, speed and round trip checks
+	{
+		RankBenchOptions options;
+		options.positions = getIntOption(argc, argv, "--positions", 65536);
+		options.rounds = getIntOption(argc, argv, "--rounds", 20);
+		options.seed = (uint64_t)getIntOption(argc, argv, "--seed", 1);
+
+		RankBench bench(options);
+		return bench.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (mode == "--engine") // text protocol on stdin/stdout for GUIs and batch drivers, see EngineProtocol.h
+	{
+		EngineProtocol protocol(std::cin, std::cout, getIntOption(argc, argv, "--depth", 3));
+		return protocol.run();
+	}
+
+	if (mode == "--serve") // analysis service on 127.0.0.1, see AnalysisServer.h for the request format
+	{
+		AnalysisServerOptions options;
+		options.port = (unsigned short)getIntOption(argc, argv, "--port", 5055);
+		options.threads = getIntOption(argc, argv, "--threads", 0);
+		options.defaultDepth = getIntOption(argc, argv, "--depth", 4);
+
+		AnalysisServer server(options);
+		return server.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (mode == "--hash-save" || mode == "--hash-load") // --hash-save|--hash-load <file> with --shared-hash or --hash-file
+	{
+		TranspositionTable table;
+		if (argc < 3 || !table.open(hashBackend)) return EXIT_FAILURE;
+		if (mode == "--hash-save" && table.isNew())
+		{
+			// Nothing searched into it, the table the engines used was removed or went away with them
+			std::cerr << "No hash table to save, it was created just now" << std::endl;
+			if (!hashBackend.sharedName.empty()) SharedMemory::removeNamed(hashBackend.sharedName);
+			return EXIT_FAILURE;
+		}
+		bool saved = mode == "--hash-save" ? table.save(argv[2]) : table.load(argv[2]);
+		std::cout << (saved ? "Done, " : "Failed, ") << table.getPermilleFull() << " permille full" << std::endl;
+		return saved ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (mode == "--hash-remove") // deletes the --shared-hash table, engines still attached keep using it
+	{
+		if (!SharedMemory::NAMED_OUTLIVES_PROCESSES)
+		{
+			std::cerr << "A --shared-hash table cannot be removed on this platform, it goes away with the last "
+				"process using it. Use --hash-file for a table that can be deleted" << std::endl;
+			return EXIT_FAILURE;
+		}
+		return SharedMemory::removeNamed(hashBackend.sharedName) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (mode == "--record-stats") // --record-stats <file>
+	{
+		return argc > 2 && printRecordSummary(argv[2]) ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (mode == "--tune") // fit evaluation weights to self-play results
+	{
+		TunerOptions options;
+		options.games = getIntOption(argc, argv, "--games", 2000);
+		options.depth = getIntOption(argc, argv, "--depth", 2);
+		options.threads = getIntOption(argc, argv, "--threads", 0);
+		options.randomPlacements = getIntOption(argc, argv, "--random-placements", 4);
+		options.seed = (uint64_t)getIntOption(argc, argv, "--seed", 1);
+		options.maxIterations = getIntOption(argc, argv, "--iterations", 200);
+		options.dataPath = getOption(argc, argv, "--data", "");
+		options.outPath = getOption(argc, argv, "--out", EvalParams::DEFAULT_PATH);
+
+		Tuner tuner(options);
+		return tuner.run() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (mode == "--train-net") // fit the evaluation network to self-play results, load it with --nnue
+	{
+		TunerOptions options;
+		options.games = getIntOption(argc, argv, "--games", 2000);
+		options.depth = getIntOption(argc, argv, "--depth", 2);
+		options.threads = getIntOption(argc, argv, "--threads", 0);
+		options.randomPlacements = getIntOption(argc, argv, "--random-placements", 4);
+		options.seed = (uint64_t)getIntOption(argc, argv, "--seed", 1);
+		options.epochs = getIntOption(argc, argv, "--epochs", 20);
+		options.dataPath = getOption(argc, argv, "--data", "");
+		options.outPath = getOption(argc, argv, "--out", NeuralNet::DEFAULT_PATH);
+
+		Tuner tuner(options);
+		return tuner.runNetwork() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
 	Game game;
+	std::string recordPath = getOption(argc, argv, "--record", "");
+	if (!recordPath.empty())
+	{
+		game.setRecordFile(recordPath);
+	}
+
+	if (hasFlag(argc, argv, "--fixed-render")) // redraw every pass like before, for CPU comparisons
+	{
+		game.setEventDrivenRendering(false);
+	}
 	game.run();
 
+#ifdef BOARDGAME_PROFILE
+	Profiler::get().end();
+#endif
+
 	return EXIT_SUCCESS;
 }
\ No newline at end of file